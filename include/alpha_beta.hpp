@@ -0,0 +1,54 @@
+#ifndef ALPHA_BETA_HPP
+#define ALPHA_BETA_HPP
+
+#include <cstdint>
+#include <array>
+#include <chrono>
+#include "rules.hpp"
+#include "transposition.hpp"
+
+#define AI_MAX_DEPTH 32
+#define AI_INFINITY 1000000
+#define AI_WIN 100000 // minus the plies to reach the win, so the shortest win is preferred
+#define AI_ACTION_KEYS (4 + CARD_COUNT * (BOARD_CELLS + 1)) // moves, then every card and target
+
+struct SearchResult
+{
+	Action action;
+	int score; // from the point of view of the player to play
+	int depth; // last depth searched completely
+	std::uint64_t nodes;
+	double time; // seconds
+};
+
+// iterative deepening alpha-beta over the actions of rules.hpp
+// one ply is one action, a player playing a card then moving plays two plies in a row, so the search
+// maximizes or minimizes depending on who is to play instead of alternating
+// the state given to search() should only hold what the player to play knows (see restrict_view)
+// the positions searched are kept in a transposition table between the searches, the scores are stored
+// for orange so the table stays valid whichever fruit the next search is for
+class AlphaBeta
+{
+	public:
+		AlphaBeta(std::size_t table_megabytes = TT_DEFAULT_MB);
+		SearchResult search(const GameState& state, double seconds); // returns before the time budget is over
+
+	private:
+		int alpha_beta(const GameState& state, int depth, int ply, int alpha, int beta);
+		int evaluate(const GameState& state) const;
+		void order(std::array<Action, MAX_ACTIONS>& actions, int count, int ply, const Action* best) const;
+		int key(const Action& action) const;
+		int to_table(int score, int ply) const;
+		int from_table(int score, int ply) const;
+		BOUND table_bound(BOUND bound) const; // same in both directions
+
+		int m_root; // fruit searching
+		std::chrono::steady_clock::time_point m_deadline;
+		bool m_abort;
+		std::uint64_t m_nodes;
+		std::array<std::array<Action, 2>, AI_MAX_DEPTH> m_killer; // last actions that caused a cutoff at each ply
+		std::array<int, AI_ACTION_KEYS> m_history; // cutoffs caused by each action, weighted by depth
+		TranspositionTable m_table;
+};
+
+#endif
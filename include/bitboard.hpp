@@ -0,0 +1,196 @@
+#ifndef BITBOARD_HPP
+#define BITBOARD_HPP
+
+#include <cstdint>
+#include <array>
+#include "protocol.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// about the bitboards
+// one bit per cell, bit index = row * 8 + column, row 0 is the top of the board and column 0 its left side
+// (same indexing as the board cells of protocol.hpp)
+
+using Bitboard = std::uint64_t;
+
+#define COLUMN_LEFT 0x0101010101010101ULL
+#define COLUMN_RIGHT 0x8080808080808080ULL
+
+inline int popcount(Bitboard b)
+{
+#ifdef _MSC_VER
+	return static_cast<int>(__popcnt64(b));
+#else
+	return __builtin_popcountll(b);
+#endif
+}
+
+// index of the lowest set bit, b must not be 0
+inline int lowest_bit(Bitboard b)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward64(&index, b);
+	return static_cast<int>(index);
+#else
+	return __builtin_ctzll(b);
+#endif
+}
+
+inline Bitboard square(int index)
+{
+	return Bitboard(1) << index;
+}
+
+// moves every bit one cell in the direction, bits leaving the board are dropped
+inline Bitboard shift(Bitboard b, DIRECTION direction)
+{
+	switch (direction)
+	{
+		case DIRECTION::UP:
+			return b >> 8;
+		case DIRECTION::DOWN:
+			return b << 8;
+		case DIRECTION::RIGHT:
+			return (b & ~COLUMN_RIGHT) << 1;
+		case DIRECTION::LEFT:
+			return (b & ~COLUMN_LEFT) >> 1;
+	}
+	return 0;
+}
+
+inline DIRECTION opposite(DIRECTION direction)
+{
+	switch (direction)
+	{
+		case DIRECTION::UP:
+			return DIRECTION::DOWN;
+		case DIRECTION::DOWN:
+			return DIRECTION::UP;
+		case DIRECTION::RIGHT:
+			return DIRECTION::LEFT;
+		default:
+			return DIRECTION::RIGHT;
+	}
+}
+
+// what a push did, enough to replay it (animation, move preview)
+struct PushResult
+{
+	Bitboard moved; // cells the moving fruits started from
+	Bitboard killed; // among moved, the fruits that left the board, fell on a dead tile or on a trap
+};
+
+struct BitBoard
+{
+	Bitboard m_alive;
+	Bitboard m_trap;
+	Bitboard m_orange;
+	Bitboard m_banane;
+	Bitboard m_petrified; // subset of m_orange | m_banane, stones belong to nobody
+
+	Bitboard fruits(int fruit) const { return (fruit == 0) ? m_orange : m_banane; }
+	Bitboard free_fruits(int fruit) const { return fruits(fruit) & ~m_petrified; }
+	Bitboard occupied() const { return m_orange | m_banane; }
+	int count(int fruit) const { return popcount(fruits(fruit)); }
+
+	// -1 => none, 0 => orange, 1 => banane
+	int fruit(int index) const
+	{
+		Bitboard b{ square(index) };
+		return (m_orange & b) ? 0 : ((m_banane & b) ? 1 : -1);
+	}
+	bool is_alive(int index) const { return (m_alive & square(index)) != 0; }
+	bool is_trap(int index) const { return (m_trap & square(index)) != 0; }
+	bool is_petrified(int index) const { return (m_petrified & square(index)) != 0; }
+
+	// wire encoding, see protocol.hpp
+	std::uint8_t cell(int index) const
+	{
+		Bitboard b{ square(index) };
+		std::uint8_t cell{ static_cast<std::uint8_t>(fruit(index) + 1) };
+		cell |= (m_petrified & b) ? CELL_PETRIFIED : 0;
+		cell |= (m_alive & b) ? CELL_ALIVE : 0;
+		cell |= (m_trap & b) ? CELL_TRAP : 0;
+		return cell;
+	}
+
+	void set_cell(int index, std::uint8_t cell)
+	{
+		Bitboard b{ square(index) };
+		int fruit{ (cell & CELL_FRUIT_MASK) - 1 };
+		m_orange = (fruit == 0) ? (m_orange | b) : (m_orange & ~b);
+		m_banane = (fruit == 1) ? (m_banane | b) : (m_banane & ~b);
+		m_petrified = ((cell & CELL_PETRIFIED) && fruit >= 0) ? (m_petrified | b) : (m_petrified & ~b);
+		m_alive = (cell & CELL_ALIVE) ? (m_alive | b) : (m_alive & ~b);
+		m_trap = (cell & CELL_TRAP) ? (m_trap | b) : (m_trap & ~b);
+	}
+
+	void set_cells(const std::array<std::uint8_t, BOARD_CELLS>& cells)
+	{
+		m_alive = m_trap = m_orange = m_banane = m_petrified = 0;
+		for (int index{ 0 }; index < BOARD_CELLS; ++index)
+		{
+			set_cell(index, cells[index]);
+		}
+	}
+
+	void get_cells(std::array<std::uint8_t, BOARD_CELLS>& cells) const
+	{
+		for (int index{ 0 }; index < BOARD_CELLS; ++index)
+		{
+			cells[index] = cell(index);
+		}
+	}
+
+	// every free fruit of the side moves one cell, pushing the fruits in front of it
+	// a line ending on a petrified fruit does not move, fruits moving out of the board,
+	// on a dead tile or on a trap are eliminated (the trapped tile with them)
+	PushResult push(int fruit, DIRECTION direction)
+	{
+		return push(free_fruits(fruit), direction);
+	}
+
+	// same with only the given free fruits taking the initiative (solo card)
+	PushResult push(Bitboard movers, DIRECTION direction)
+	{
+		Bitboard occupied{ m_orange | m_banane };
+		Bitboard free{ occupied & ~m_petrified };
+
+		// fruits pushed by a moving fruit move too, a line is at most 8 long
+		Bitboard moving{ movers & free };
+		for (int i{ 0 }; i < 7; ++i)
+		{
+			moving |= shift(moving, direction) & free;
+		}
+
+		// lines blocked by a petrified fruit, from the front to the back
+		DIRECTION back{ opposite(direction) };
+		Bitboard blocked{ shift(m_petrified, back) & moving };
+		for (int i{ 0 }; i < 7; ++i)
+		{
+			blocked |= shift(blocked, back) & moving;
+		}
+		moving &= ~blocked;
+
+		Bitboard orange_moved{ shift(m_orange & moving, direction) };
+		Bitboard banane_moved{ shift(m_banane & moving, direction) };
+		Bitboard landed{ orange_moved | banane_moved };
+		Bitboard dead{ ~m_alive | m_trap };
+
+		PushResult result;
+		result.moved = moving;
+		// fruits leaving the board vanish from the shifted masks, the others die where they land
+		result.killed = moving & ~shift(landed & ~dead, back);
+
+		m_alive &= ~(landed & m_trap);
+		m_trap &= ~landed;
+		m_orange = (m_orange & ~moving) | (orange_moved & ~dead);
+		m_banane = (m_banane & ~moving) | (banane_moved & ~dead);
+		return result;
+	}
+};
+
+#endif
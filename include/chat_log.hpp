@@ -0,0 +1,54 @@
+#ifndef CHAT_LOG_HPP
+#define CHAT_LOG_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+// ring buffer of the last chat lines, owned by the render thread
+// appending is O(1) : the oldest line is overwritten in place and its string storage reused
+class ChatLog
+{
+	public:
+		ChatLog(std::size_t history) :
+			m_line(history > 0 ? history : 1),
+			m_head(0),
+			m_count(0)
+		{}
+
+		void push(std::string_view text)
+		{
+			m_line[m_head].assign(text.data(), text.size());
+			m_head = (m_head + 1) % m_line.size();
+			m_count = (m_count < m_line.size()) ? m_count + 1 : m_count;
+		}
+
+		void clear()
+		{
+			m_head = 0;
+			m_count = 0;
+		}
+
+		std::size_t size() const { return m_count; }
+		std::size_t capacity() const { return m_line.size(); }
+
+		// i = 0 is the oldest line kept
+		const std::string& line(std::size_t i) const
+		{
+			return m_line[(m_head + m_line.size() - m_count + i) % m_line.size()];
+		}
+
+		// index of the first line to display when only the last visible_lines lines fit on screen
+		std::size_t first_visible(std::size_t visible_lines) const
+		{
+			return (m_count > visible_lines) ? m_count - visible_lines : 0;
+		}
+
+	private:
+		std::vector<std::string> m_line;
+		std::size_t m_head; // next slot to write
+		std::size_t m_count;
+};
+
+#endif
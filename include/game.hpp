@@ -6,9 +6,10 @@
 #include <utility>
 #include <cmath>
 #include <thread>
-#include <mutex>
-#include <queue>
+#include <atomic>
+#include <string_view>
 #include <map>
+#include <algorithm>
 #include <iterator>
 #include <sstream>
 #include "scene.hpp"
@@ -17,7 +18,19 @@
 #include "character.hpp"
 #include "user_interface.hpp"
 #include "network_client.hpp"
+#include "message_queue.hpp"
+#include "protocol.hpp"
+#include "chat_log.hpp"
+#include "bitboard.hpp"
+#include "rules.hpp"
 #include "mouse.hpp"
+#include "network_stats.hpp"
+
+#define CHAT_HISTORY 128 // chat lines kept
+#define CHAT_VISIBLE_LINES 7
+#define PENDING_ACTIONS 8 // actions sent and not yet confirmed by the server
+#define MOVE_STEP_TIME 0.15f // seconds for a fruit to cross one cell
+#define GHOST_OPACITY 0.4f // fruits and tiles changed by the hovered move
 
 // eye colors
 #define JAUNE	55 / 360.0f
@@ -335,6 +348,104 @@ struct Avatar
 		glBindVertexArray(0);
 	}
 
+	// values received from the network, unknown features are left unchanged
+	void set_attributes(const AvatarData& data)
+	{
+		m_skin_color_id = data.skin_color % m_skin_color.size();
+		m_hair_color_id = data.hair_color % m_hair_color.size();
+		m_eyes_color_id = data.eyes_color % m_eyes_color.size();
+		if (data.gender == 0)
+		{
+			m_gender = GENDER::MALE;
+			// hair
+			switch (data.hair)
+			{
+			case 0:
+				m_hair = HAIR::MIXTE;
+				break;
+			case 1:
+				m_hair = HAIR::HERISSON;
+				break;
+			case 2:
+				m_hair = HAIR::DECOIFFE;
+				break;
+			case 3:
+				m_hair = HAIR::ARRIERE;
+				break;
+			case 4:
+				m_hair = HAIR::MECHE_AVANT;
+				break;
+			default:
+				break;
+			};
+			// eyes
+			switch (data.eyes)
+			{
+			case 0:
+				m_eyes = EYES::MANGA;
+				break;
+			case 1:
+				m_eyes = EYES::AMANDE;
+				break;
+			case 2:
+				m_eyes = EYES::GROS;
+				break;
+			default:
+				break;
+			};
+		}
+		else if (data.gender == 1)
+		{
+			m_gender = GENDER::FEMALE;
+			// hair
+			switch (data.hair)
+			{
+			case 0:
+				m_hair = HAIR::MIXTE;
+				break;
+			case 5:
+				m_hair = HAIR::MI_LONG;
+				break;
+			case 6:
+				m_hair = HAIR::FRANGE;
+				break;
+			case 7:
+				m_hair = HAIR::AU_BOL;
+				break;
+			case 8:
+				m_hair = HAIR::PONYTAIL;
+				break;
+			default:
+				break;
+			};
+			// eyes
+			switch (data.eyes)
+			{
+			case 0:
+				m_eyes = EYES::MANGA;
+				break;
+			case 3:
+				m_eyes = EYES::EGYPTE;
+				break;
+			case 4:
+				m_eyes = EYES::MASCARA;
+				break;
+			default:
+				break;
+			};
+		}
+		// mouth
+		if (data.mouth == 0) {
+			m_mouth = MOUTH::PETITE;
+		}
+		else if (data.mouth == 1) {
+			m_mouth = MOUTH::MOYENNE;
+		}
+		else if (data.mouth == 2) {
+			m_mouth = MOUTH::GRANDE;
+		}
+	}
+
 	GENDER m_gender; // 0 = male, 1 = female
 	HAIR m_hair;
 	EYES m_eyes;
@@ -355,37 +466,40 @@ struct Avatar
 
 struct Cards
 {
-	const std::array<Texture, 12> m_description = {
-		createTexture("assets/cartes/enclume_desc.tga", TEXTURE_TYPE::DIFFUSE, true),			// 0
-		createTexture("assets/cartes/celerite_desc.tga", TEXTURE_TYPE::DIFFUSE, true),			// 1
-		createTexture("assets/cartes/confiscation_desc.tga", TEXTURE_TYPE::DIFFUSE, true),		// 2
-		createTexture("assets/cartes/renfort_desc.tga", TEXTURE_TYPE::DIFFUSE, true),			// 3
-		createTexture("assets/cartes/desordre_desc.tga", TEXTURE_TYPE::DIFFUSE, true),			// 4
-		createTexture("assets/cartes/petrification_desc.tga", TEXTURE_TYPE::DIFFUSE, true),		// 5
-		createTexture("assets/cartes/vachette_desc.tga", TEXTURE_TYPE::DIFFUSE, true),			// 6
-		createTexture("assets/cartes/conversion_desc.tga", TEXTURE_TYPE::DIFFUSE, true),		// 7
-		createTexture("assets/cartes/charge_desc.tga", TEXTURE_TYPE::DIFFUSE, true),			// 8
-		createTexture("assets/cartes/entracte_desc.tga", TEXTURE_TYPE::DIFFUSE, true),			// 9
-		createTexture("assets/cartes/solo_desc.tga", TEXTURE_TYPE::DIFFUSE, true),				// 10
-		createTexture("assets/cartes/piege_desc.tga", TEXTURE_TYPE::DIFFUSE, true)				// 11
+	static constexpr std::array<const char*, 12> DESCRIPTION_IMAGES = {
+		"assets/cartes/enclume_desc.tga",			// 0
+		"assets/cartes/celerite_desc.tga",			// 1
+		"assets/cartes/confiscation_desc.tga",		// 2
+		"assets/cartes/renfort_desc.tga",			// 3
+		"assets/cartes/desordre_desc.tga",			// 4
+		"assets/cartes/petrification_desc.tga",		// 5
+		"assets/cartes/vachette_desc.tga",			// 6
+		"assets/cartes/conversion_desc.tga",		// 7
+		"assets/cartes/charge_desc.tga",			// 8
+		"assets/cartes/entracte_desc.tga",			// 9
+		"assets/cartes/solo_desc.tga",				// 10
+		"assets/cartes/piege_desc.tga"				// 11
 	};
 
-	const std::array<Texture, 13> m_tex = {
-		createTexture("assets/cartes/enclume.tga", TEXTURE_TYPE::DIFFUSE, true),		// 0
-		createTexture("assets/cartes/celerite.tga", TEXTURE_TYPE::DIFFUSE, true),		// 1
-		createTexture("assets/cartes/confiscation.tga", TEXTURE_TYPE::DIFFUSE, true),	// 2
-		createTexture("assets/cartes/renfort.tga", TEXTURE_TYPE::DIFFUSE, true),		// 3
-		createTexture("assets/cartes/desordre.tga", TEXTURE_TYPE::DIFFUSE, true),		// 4
-		createTexture("assets/cartes/petrification.tga", TEXTURE_TYPE::DIFFUSE, true),	// 5
-		createTexture("assets/cartes/vachette.tga", TEXTURE_TYPE::DIFFUSE, true),		// 6
-		createTexture("assets/cartes/conversion.tga", TEXTURE_TYPE::DIFFUSE, true),		// 7
-		createTexture("assets/cartes/charge.tga", TEXTURE_TYPE::DIFFUSE, true),			// 8
-		createTexture("assets/cartes/entracte.tga", TEXTURE_TYPE::DIFFUSE, true),		// 9
-		createTexture("assets/cartes/solo.tga", TEXTURE_TYPE::DIFFUSE, true),			// 10
-		createTexture("assets/cartes/piege.tga", TEXTURE_TYPE::DIFFUSE, true),			// 11
-		createTexture("assets/cartes/verso.tga", TEXTURE_TYPE::DIFFUSE, true)			// 12
+	static constexpr std::array<const char*, 13> CARD_IMAGES = {
+		"assets/cartes/enclume.tga",		// 0
+		"assets/cartes/celerite.tga",		// 1
+		"assets/cartes/confiscation.tga",	// 2
+		"assets/cartes/renfort.tga",		// 3
+		"assets/cartes/desordre.tga",		// 4
+		"assets/cartes/petrification.tga",	// 5
+		"assets/cartes/vachette.tga",		// 6
+		"assets/cartes/conversion.tga",		// 7
+		"assets/cartes/charge.tga",			// 8
+		"assets/cartes/entracte.tga",		// 9
+		"assets/cartes/solo.tga",			// 10
+		"assets/cartes/piege.tga",			// 11
+		"assets/cartes/verso.tga"			// 12
 	};
 
+	std::array<AtlasRegion, 12> m_description;
+	std::array<AtlasRegion, 13> m_tex;
+
 	// -1 if no card on the slot
 	// positive numbers are the index to fetch data in the arrays "m_tex" and "description"
 	int m_slot[16] = {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1};
@@ -393,41 +507,49 @@ struct Cards
 
 	Cards()
 	{
-		m_sprite[0] = std::make_unique<Sprite>(100, glm::vec2(19, 728 - 197 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[0] = std::make_unique<Sprite>(100, glm::vec2(19, 728 - 197 - 117), glm::vec2(84, 117));
 		m_sprite[0]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[1] = std::make_unique<Sprite>(101, glm::vec2(125, 728 - 197 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[1] = std::make_unique<Sprite>(101, glm::vec2(125, 728 - 197 - 117), glm::vec2(84, 117));
 		m_sprite[1]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[2] = std::make_unique<Sprite>(102, glm::vec2(19, 728 - 320 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[2] = std::make_unique<Sprite>(102, glm::vec2(19, 728 - 320 - 117), glm::vec2(84, 117));
 		m_sprite[2]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[3] = std::make_unique<Sprite>(103, glm::vec2(125, 728 - 320 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[3] = std::make_unique<Sprite>(103, glm::vec2(125, 728 - 320 - 117), glm::vec2(84, 117));
 		m_sprite[3]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[4] = std::make_unique<Sprite>(104, glm::vec2(19, 728 - 444 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[4] = std::make_unique<Sprite>(104, glm::vec2(19, 728 - 444 - 117), glm::vec2(84, 117));
 		m_sprite[4]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[5] = std::make_unique<Sprite>(105, glm::vec2(125, 728 - 444 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[5] = std::make_unique<Sprite>(105, glm::vec2(125, 728 - 444 - 117), glm::vec2(84, 117));
 		m_sprite[5]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[6] = std::make_unique<Sprite>(106, glm::vec2(19, 728 - 568 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[6] = std::make_unique<Sprite>(106, glm::vec2(19, 728 - 568 - 117), glm::vec2(84, 117));
 		m_sprite[6]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[7] = std::make_unique<Sprite>(107, glm::vec2(125, 728 - 568 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[7] = std::make_unique<Sprite>(107, glm::vec2(125, 728 - 568 - 117), glm::vec2(84, 117));
 		m_sprite[7]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
 		
-		m_sprite[8] = std::make_unique<Sprite>(200, glm::vec2(839, 728 - 197 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[8] = std::make_unique<Sprite>(200, glm::vec2(839, 728 - 197 - 117), glm::vec2(84, 117));
 		m_sprite[8]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[9] = std::make_unique<Sprite>(201, glm::vec2(944, 728 - 197 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[9] = std::make_unique<Sprite>(201, glm::vec2(944, 728 - 197 - 117), glm::vec2(84, 117));
 		m_sprite[9]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[10] = std::make_unique<Sprite>(202, glm::vec2(839, 728 - 320 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[10] = std::make_unique<Sprite>(202, glm::vec2(839, 728 - 320 - 117), glm::vec2(84, 117));
 		m_sprite[10]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[11] = std::make_unique<Sprite>(203, glm::vec2(944, 728 - 320 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[11] = std::make_unique<Sprite>(203, glm::vec2(944, 728 - 320 - 117), glm::vec2(84, 117));
 		m_sprite[11]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[12] = std::make_unique<Sprite>(204, glm::vec2(839, 728 - 444 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[12] = std::make_unique<Sprite>(204, glm::vec2(839, 728 - 444 - 117), glm::vec2(84, 117));
 		m_sprite[12]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[13] = std::make_unique<Sprite>(205, glm::vec2(944, 728 - 444 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[13] = std::make_unique<Sprite>(205, glm::vec2(944, 728 - 444 - 117), glm::vec2(84, 117));
 		m_sprite[13]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[14] = std::make_unique<Sprite>(206, glm::vec2(839, 728 - 568 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[14] = std::make_unique<Sprite>(206, glm::vec2(839, 728 - 568 - 117), glm::vec2(84, 117));
 		m_sprite[14]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
-		m_sprite[15] = std::make_unique<Sprite>(207, glm::vec2(944, 728 - 568 - 117), glm::vec2(84, 117), 1050, 728);
+		m_sprite[15] = std::make_unique<Sprite>(207, glm::vec2(944, 728 - 568 - 117), glm::vec2(84, 117));
 		m_sprite[15]->set_background_color(glm::vec4(0.835f, 0.843f, 0.533f, 1.0f));
 	}
 
+	void load_images(TextureAtlas& atlas)
+	{
+		for (int i{ 0 }; i < m_description.size(); ++i)
+			m_description[i] = atlas.get(DESCRIPTION_IMAGES[i]);
+		for (int i{ 0 }; i < m_tex.size(); ++i)
+			m_tex[i] = atlas.get(CARD_IMAGES[i]);
+	}
+
 	bool hovered_card(int mouseX, int mouseY, int& card_id)
 	{
 		bool hovered{ false };
@@ -445,131 +567,319 @@ struct Cards
 		return hovered;
 	}
 
-	void draw()
+	// fill my slots from the hand bitmask (lowest card ids first), the opponent's hand is face down
+	void set_hand(int fruit, std::uint16_t cards)
+	{
+		std::array<int, 3> card_id = { -1, -1, -1 };
+		int card_count{ 0 };
+		for (int id{ 0 }; id < 12 && card_count < 3; ++id)
+		{
+			if (cards & (1 << id))
+			{
+				card_id[card_count++] = id;
+			}
+		}
+		int mine{ (fruit == 0) ? 0 : 8 };
+		int opponent{ (fruit == 0) ? 8 : 0 };
+		for (int i{ 0 }; i < 3; ++i)
+		{
+			m_slot[mine + i] = card_id[i];
+			m_slot[opponent + i] = 12;
+		}
+	}
+
+	void draw(SpriteBatch& batch)
 	{
 		for (int i{ 0 }; i < m_sprite.size(); ++i){
 			int slot = m_slot[i];
 			if (slot != -1)
 			{
-				m_sprite[i]->set_background_img_gl(m_tex[slot].id);
+				m_sprite[i]->set_background_img_gl(m_tex[slot]);
 				m_sprite[i]->use_background_img_gl();
 			}
 			else
 			{
 				m_sprite[i]->use_background_color();
 			}
-			m_sprite[i]->draw();
+			m_sprite[i]->draw(batch);
 		}
 	}
 };
 
-struct Fruit
+struct FruitAnimation
 {
-	// >>>>>>>>>> methods
-	Fruit() : m_type(-1), m_petrified(false) {}
-	// >>>>>>>>>> properties
-	int m_type;	// -1 = none, 0 = orange, 1 = banane
-	bool m_petrified;
-};
-
-struct Tile
-{
-	// >>>>>>>>>> methods
-	Tile() : m_alive(true), m_trap(false) {}
-	// >>>>>>>>>> properties
-	bool m_alive;
-	bool m_trap;
+	glm::vec2 m_from; // sprite position before the move
+	glm::vec2 m_shift; // translation once arrived
+	float m_start; // seconds since the start of the animation
+	float m_end;
+	int m_fruit; // 0 => orange, 1 => banane
+	bool m_dies; // vanishes on arrival : out of the board, dead tile or trap
 };
 
 struct Board
 {
 	Board() :
-		m_square(0, glm::vec2(0), glm::vec2(49), 1050, 728),
-		m_rect(0, glm::vec2(0), glm::vec2(49, 73), 1050, 728)
-	{}
+		m_bits{},
+		m_before{},
+		m_still{},
+		m_moving{},
+		m_moving_count(0),
+		m_animation_time(0.0f),
+		m_animation_length(0.0f),
+		m_previews{},
+		m_playable(0),
+		m_previewed(-1),
+		m_square(0, glm::vec2(0), glm::vec2(49)),
+		m_rect(0, glm::vec2(0), glm::vec2(49, 73))
+	{
+		m_bits.m_alive = ~Bitboard(0);
+	}
 
-	int orange_count()
+	void load_images(TextureAtlas& atlas)
 	{
-		int count{ 0 };
-		for (int i{ 0 }; i < 8; ++i) {
-			for (int j{ 0 }; j < 8; ++j) {
-				count += (m_fruit[j][i].m_type == 0) ? 1 : 0;
-			}
-		}
-		return count;
+		m_tex[0] = atlas.get("assets/orange.tga");
+		m_tex[1] = atlas.get("assets/banane.tga");
+		m_tex[2] = atlas.get("assets/board.tga");
+		m_tex[3] = atlas.get("assets/board_bottom.tga");
 	}
 
-	int banane_count()
+	int orange_count() const
 	{
-		int count{ 0 };
-		for (int i{ 0 }; i < 8; ++i) {
-			for (int j{ 0 }; j < 8; ++j) {
-				count += (m_fruit[j][i].m_type == 1) ? 1 : 0;
-			}
+		return m_bits.count(0);
+	}
+
+	int banane_count() const
+	{
+		return m_bits.count(1);
+	}
+
+	// -1 => none, 0 => orange, 1 => banane
+	int fruit(int row, int col) const
+	{
+		return m_bits.fruit(row * 8 + col);
+	}
+
+	void set_bits(const BitBoard& bits)
+	{
+		m_bits = bits;
+	}
+
+	// index of the cell under the mouse, -1 if none
+	int hovered_cell(int mouseX, int mouseY) const
+	{
+		int col{ (mouseX - (525 - 49 * 4)) / 49 };
+		int row{ (645 + 49 - mouseY) / 49 };
+		if (mouseX < 525 - 49 * 4 || mouseY > 645 + 49 || col > 7 || row > 7)
+			return -1;
+		return row * 8 + col;
+	}
+
+	// boards after each move of the player from state, computed once per position so that hovering
+	// an arrow only picks one of them. playable => the player can move now
+	void set_previews(const GameState& state, bool playable)
+	{
+		m_playable = 0;
+		if (!playable)
+			return;
+		for (int i{ 0 }; i < 4; ++i)
+		{
+			Action move{ ACTION::MOVE, static_cast<std::uint8_t>(i), NO_CELL };
+			if (!is_legal(state, move))
+				continue;
+			GameState next{ state };
+			apply_action(next, move);
+			m_previews[i] = next.m_board;
+			m_playable |= 1 << i;
 		}
-		return count;
 	}
 
-	void draw_tiles()
+	// direction of the hovered arrow, -1 => none
+	void preview(int direction)
+	{
+		m_previewed = direction;
+	}
+
+	// board of the hovered move, nullptr if there is nothing to preview
+	const BitBoard* previewed() const
+	{
+		if (m_previewed < 0 || !(m_playable & (1 << m_previewed)) || m_moving_count > 0)
+			return nullptr;
+		return &m_previews[m_previewed];
+	}
+
+	void draw_tiles(SpriteBatch& batch)
 	{
+		const BitBoard& shown{ (m_moving_count > 0) ? m_before : m_bits };
+		const BitBoard* ghost{ previewed() };
 		glm::vec2 start(525-(49*4), 645);
 		for (int i{ 0 }; i < 8; ++i) {
 			for (int j{ 0 }; j < 8; ++j) {
-				if (!m_tile[j][i].m_alive) { continue; }
+				if (!shown.is_alive(j * 8 + i)) { continue; }
+				// tiles the move would kill are faded
+				m_square.set_opacity((ghost && !ghost->is_alive(j * 8 + i)) ? GHOST_OPACITY : 1.0f);
 				glm::vec2 shift(49 * i, -49 * j);
 				if (j == 7) {	// bottom line
-					m_square.set_background_img_gl(m_tex[2].id);
+					m_square.set_background_img_gl(m_tex[2]);
 					m_square.use_background_img_gl();
 					m_square.set_pos(start + shift);
-					m_square.draw();
+					m_square.draw(batch);
 				}
 				else {			// elsewhere
-					m_square.set_background_img_gl(m_tex[3].id);
+					m_square.set_background_img_gl(m_tex[3]);
 					m_square.use_background_img_gl();
 					m_square.set_pos(start + shift);
-					m_square.draw();
+					m_square.draw(batch);
 				}
 			}
 		}
+		m_square.set_opacity(1.0f);
 	}
 
-	void draw_fruits(bool animate = false, float animationTime = 0.0f)
+	// trajectories of the fruits moved by a move, computed once here, each frame only interpolates them
+	// the board keeps showing the tiles and the other fruits of before the move until the animation ends
+	void animate(const BitBoard& before, const MoveSteps& steps)
 	{
-		// si on est en cours d'animation, on update la position du sprite
-		// en fonction d'animationTime avec sprite->setPos();
-		// et on envoit les donnes d'animation au sprite avec le rapport animationTime / animationLength
-		// seulement si animationTime est positif ou nul
-		glm::vec2 start_orange(525 - (49 * 4), 645);
-		glm::vec2 start_banane(525 - (49 * 4), 645 + 24);
-		for (int i{ 0 }; i < 8; ++i) {
-			for (int j{ 0 }; j < 8; ++j) {
-				glm::vec2 shift(49 * i, -49 * j);
-				if (m_fruit[j][i].m_type == 0)
-				{
-					m_square.set_background_img_gl(m_tex[0].id);
-					m_square.use_background_img_gl();
-					m_square.set_pos(start_orange + shift);
-					m_square.draw();
-				}
-				else if (m_fruit[j][i].m_type == 1)
+		if (steps.count == 0)
+			return;
+		glm::vec2 cell_shift;
+		int index_shift;
+		switch (steps.direction)
+		{
+			case DIRECTION::UP: cell_shift = glm::vec2(0, 49); index_shift = -8; break;
+			case DIRECTION::DOWN: cell_shift = glm::vec2(0, -49); index_shift = 8; break;
+			case DIRECTION::RIGHT: cell_shift = glm::vec2(49, 0); index_shift = 1; break;
+			default: cell_shift = glm::vec2(-49, 0); index_shift = -1; break;
+		}
+		m_before = before;
+		m_moving_count = 0;
+		m_animation_time = 0.0f;
+		m_animation_length = steps.count * MOVE_STEP_TIME;
+		// moving fruit standing on each cell at the start of the step, -1 if none
+		std::array<std::int8_t, BOARD_CELLS> on_cell;
+		on_cell.fill(-1);
+		Bitboard movers{ 0 };
+		for (int step{ 0 }; step < steps.count; ++step)
+		{
+			const PushResult& push{ steps.push[step] };
+			// every mover leaves its cell before any lands, a line moves as a whole
+			std::array<std::int8_t, BOARD_CELLS> next{ on_cell };
+			for (Bitboard b{ push.moved }; b; b &= b - 1)
+			{
+				next[lowest_bit(b)] = -1;
+			}
+			for (Bitboard b{ push.moved }; b; b &= b - 1)
+			{
+				int index{ lowest_bit(b) };
+				int id{ on_cell[index] };
+				if (id == -1)
 				{
-					m_rect.set_background_img_gl(m_tex[1].id);
-					m_rect.use_background_img_gl();
-					m_rect.set_pos(start_banane + shift);
-					m_rect.draw();
+					// still on its starting cell, it was not moved by the previous steps
+					id = m_moving_count++;
+					int fruit{ before.fruit(index) };
+					glm::vec2 start{ (fruit == 0) ? glm::vec2(525 - (49 * 4), 645) : glm::vec2(525 - (49 * 4), 645 + 24) };
+					m_moving[id] = FruitAnimation{ start + glm::vec2(49 * (index % 8), -49 * (index / 8)), glm::vec2(0), step * MOVE_STEP_TIME, 0.0f, fruit, false };
+					movers |= square(index);
 				}
+				FruitAnimation& fruit{ m_moving[id] };
+				fruit.m_shift += cell_shift;
+				fruit.m_end = (step + 1) * MOVE_STEP_TIME;
+				if (push.killed & square(index))
+					fruit.m_dies = true;
+				else
+					next[index + index_shift] = static_cast<std::int8_t>(id);
 			}
+			on_cell = next;
 		}
+		m_still = before;
+		m_still.m_orange &= ~movers;
+		m_still.m_banane &= ~movers;
 	}
 
-	Tile m_tile[8][8];
-	Fruit m_fruit[8][8];
-	std::array<Texture, 4> m_tex = {
-		createTexture("assets/orange.tga", TEXTURE_TYPE::DIFFUSE, true),
-		createTexture("assets/banane.tga", TEXTURE_TYPE::DIFFUSE, true),
-		createTexture("assets/board.tga", TEXTURE_TYPE::DIFFUSE, true),
-		createTexture("assets/board_bottom.tga", TEXTURE_TYPE::DIFFUSE, true)
-	};
+	void draw_fruits(SpriteBatch& batch, float delta)
+	{
+		if (m_moving_count > 0)
+		{
+			m_animation_time += delta;
+			if (m_animation_time >= m_animation_length)
+			{
+				m_moving_count = 0;
+			}
+		}
+		const BitBoard& shown{ (m_moving_count > 0) ? m_still : m_bits };
+		const BitBoard* ghost{ previewed() };
+		if (ghost)
+		{
+			// the fruits the hovered move leaves in place are drawn as usual, the ones it moves
+			// or kills are faded where they stand and where they would land
+			Bitboard orange{ shown.m_orange & ghost->m_orange };
+			Bitboard banane{ shown.m_banane & ghost->m_banane };
+			draw_fruit_cells(batch, orange, banane, 1.0f);
+			draw_fruit_cells(batch, (shown.m_orange | ghost->m_orange) & ~orange, (shown.m_banane | ghost->m_banane) & ~banane, GHOST_OPACITY);
+		}
+		else
+		{
+			draw_fruit_cells(batch, shown.m_orange, shown.m_banane, 1.0f);
+		}
+		// moving fruits : one interpolation each, the dead ones vanish where they fall
+		for (int i{ 0 }; i < m_moving_count; ++i)
+		{
+			const FruitAnimation& fruit{ m_moving[i] };
+			float t{ glm::clamp((m_animation_time - fruit.m_start) / (fruit.m_end - fruit.m_start), 0.0f, 1.0f) };
+			if (fruit.m_dies && t >= 1.0f)
+				continue;
+			Sprite& sprite{ (fruit.m_fruit == 0) ? m_square : m_rect };
+			sprite.set_background_img_gl(m_tex[fruit.m_fruit]);
+			sprite.use_background_img_gl();
+			sprite.set_pos(fruit.m_from);
+			sprite.draw(batch, fruit.m_shift * t);
+		}
+	}
+
+	void stop_animation()
+	{
+		m_moving_count = 0;
+	}
+
+	// only the occupied cells are visited
+	void draw_fruit_cells(SpriteBatch& batch, Bitboard orange, Bitboard banane, float opacity)
+	{
+		glm::vec2 start_orange(525 - (49 * 4), 645);
+		glm::vec2 start_banane(525 - (49 * 4), 645 + 24);
+		m_square.set_opacity(opacity);
+		m_rect.set_opacity(opacity);
+		for (Bitboard b{ orange }; b; b &= b - 1)
+		{
+			int index{ lowest_bit(b) };
+			glm::vec2 shift(49 * (index % 8), -49 * (index / 8));
+			m_square.set_background_img_gl(m_tex[0]);
+			m_square.use_background_img_gl();
+			m_square.set_pos(start_orange + shift);
+			m_square.draw(batch);
+		}
+		for (Bitboard b{ banane }; b; b &= b - 1)
+		{
+			int index{ lowest_bit(b) };
+			glm::vec2 shift(49 * (index % 8), -49 * (index / 8));
+			m_rect.set_background_img_gl(m_tex[1]);
+			m_rect.use_background_img_gl();
+			m_rect.set_pos(start_banane + shift);
+			m_rect.draw(batch);
+		}
+		m_square.set_opacity(1.0f);
+		m_rect.set_opacity(1.0f);
+	}
+
+	BitBoard m_bits;
+	BitBoard m_before; // board before the animated move, for its tiles
+	BitBoard m_still; // m_before without the moving fruits
+	std::array<FruitAnimation, BOARD_CELLS> m_moving;
+	int m_moving_count; // 0 => no animation
+	float m_animation_time;
+	float m_animation_length;
+	std::array<BitBoard, 4> m_previews; // board after each move, DIRECTION ordering
+	int m_playable; // bit i => m_previews[i] is a legal move of the player
+	int m_previewed; // direction of the hovered arrow, -1 => none
+	std::array<AtlasRegion, 4> m_tex; // orange, banane, tile, bottom line tile
 	Sprite m_square;
 	Sprite m_rect;
 };
@@ -649,6 +959,7 @@ class Writer
 {
 	public:
 		Writer(int screenW, int screenH) :
+			m_chatLog(CHAT_HISTORY),
 			m_cursor(screenW, screenH)
 		{
 			m_deltaWrite = 0.0f;
@@ -658,9 +969,8 @@ class Writer
 
 		void write(char* c, std::bitset<10>& userInputs, float delta, int boundX, glm::vec3 cursor_shape);
 		
-		std::array<std::string, 2> m_textInput = {"", ""};
-		std::array<std::vector<int>, 2> m_textSectionsWidth;
-		std::vector<std::string> m_chatLog;
+		std::array<std::string, 2> m_textInput = {"", ""}; // UTF-8, the cursor position is a byte offset
+		ChatLog m_chatLog; // only accessed by the render thread, lines come through g_msg2client_queue
 		Cursor m_cursor;
 		float m_deltaWrite;
 		WRITE_ACTION m_lastWriteAction;
@@ -670,13 +980,11 @@ class Writer
 		void write_aux(WRITE_ACTION writeAction, std::string& character, float delta, int boundX, glm::vec3 cursor_shape);
 };
 
-enum class MOVE
+// an action sent to the server, confirmed once the ack of the server reaches its number
+struct PendingAction
 {
-	UNDEFINED,
-	UP,
-	DOWN,
-	RIGHT,
-	LEFT
+	Action action;
+	std::uint16_t number; // m_action_count once the action was sent
 };
 
 class Game
@@ -712,7 +1020,8 @@ class Game
 		Writer& get_writer();
 		void updateUI(std::bitset<10> & inputs, char* text_input, int screenW, int screenH, float delta);
 		void swap_gender_features(Avatar::GENDER from, Avatar::GENDER to);
-		void set_animationTimer();
+		void set_network_client(NetworkClient* network);
+		RenderStats get_render_stats(); // since the previous call, once per frame
 
 	private:
 
@@ -727,6 +1036,14 @@ class Game
     private:
 
 		void drawUI(float& delta, double& elapsedTime, int width, int height, DRAWING_MODE mode = DRAWING_MODE::SOLID);
+		void post_message(MESSAGE code, const std::uint8_t* data, std::size_t size);
+		void post_command(PACKET type);
+		void poll_messages();
+		void apply_snapshot(const GameSnapshot& snapshot);
+		void apply_delta(const BoardDelta& delta);
+		void play_action(const Action& action);
+		void reconcile(std::uint16_t ack);
+		void show_prediction();
         std::unique_ptr<Text> textRenderer;
 		std::unique_ptr<Mouse> m_mouse;
 
@@ -756,22 +1073,43 @@ class Game
 		int m_turn;
 		int m_remaining_time;
 		int m_winner;
+		bool m_opponent_left; // the server ended the current game, m_winner is my fruit
 		std::string m_pseudo_orange;
 		std::string m_pseudo_banane;
-		MOVE m_move;
-		float m_animationTimer; // set to the max value (abs(-0.125f*shift) + 0.25f) amoung fruits, when it reaches zero after decrement by delta each frame, set m_move to UNDEFINED
+		NetworkClient* m_network; // used to wake up the network thread when a message is posted
+		GameSnapshot m_snapshot; // latest game state received from the network thread
+		std::uint32_t m_snapshot_version; // version of the snapshot currently displayed
+		bool m_typing; // last typing state sent to the opponent
+		GameState m_state; // confirmed by the server : latest snapshot and the deltas received since
+		GameState m_predicted; // m_state with the pending actions applied, what the board shows
+		std::array<PendingAction, PENDING_ACTIONS> m_pending; // sent to the server, oldest first
+		std::size_t m_pending_count;
+		std::uint16_t m_action_count; // actions sent since the game started, compared to the ack of the server
+		int m_selected_card; // card waiting for its target cell, -1 if none
+};
+
+inline SPSCQueue<Message, 64> g_msg2server_queue; // produced by the render thread, consumed by the network thread
+inline SPSCQueue<Message, 64> g_msg2client_queue; // produced by the network thread, consumed by the render thread
+enum class UPDATE
+{
+	SNAPSHOT,
+	DELTA,
+	OPPONENT_LEFT // the current game is won
+};
+
+// snapshots and deltas share one queue so a delta is never seen before the snapshot it applies to
+struct GameUpdate
+{
+	UPDATE m_type;
+	GameSnapshot m_snapshot;
+	BoardDelta m_delta;
 };
 
-inline std::queue<std::string> g_msg2server_queue;
-inline std::queue<std::string> g_msg2client_queue;
-inline std::mutex g_msg2server_mutex;
-inline std::mutex g_msg2client_mutex;
-inline bool g_connected{ false };
-inline std::mutex g_connected_mutex;
-inline bool g_try_connection{ false };
-inline bool g_search_opponent{ false };
-inline bool g_game_found{ false };
-inline std::string g_game_init{""};
-inline std::mutex g_game_init_mutex;
+inline SPSCQueue<GameUpdate, 8> g_game_update_queue; // decoded game states and board deltas, produced by the network thread, consumed by the render thread
+inline std::atomic<bool> g_connected{ false };
+inline std::atomic<bool> g_try_connection{ false };
+inline std::atomic<bool> g_search_opponent{ false };
+inline std::atomic<bool> g_game_found{ false };
+inline std::atomic<bool> g_opponent_typing{ false };
 
 #endif
@@ -0,0 +1,62 @@
+#ifndef LOCAL_OPPONENT_HPP
+#define LOCAL_OPPONENT_HPP
+
+#include <atomic>
+#include <array>
+#include <string>
+#include <random>
+#include "protocol.hpp"
+#include "rules.hpp"
+#include "alpha_beta.hpp"
+#include "mcts.hpp"
+#include "replay.hpp"
+#include "game.hpp"
+
+#define OPPONENT_NAME "Robot"
+#define OPPONENT_IDLE_SLEEP 5 // ms between two looks at the message queue when there is nothing to do
+
+enum class AI
+{
+	ALPHA_BETA,
+	MCTS
+};
+
+// offline opponent, takes the place of the network thread : it consumes the packets the render thread posts
+// to g_msg2server_queue and answers through g_msg2client_queue and g_game_update_queue like the server would
+// the rules are applied locally and the AI plays the other fruit, on this thread so render() never waits for it
+class LocalOpponent
+{
+	public:
+		LocalOpponent(AI ai, double think_time, const MctsOptions& mcts, unsigned int seed); // mcts.seconds is replaced by think_time
+		void run(std::atomic<bool>& run);
+		void set_replay_dir(const std::string& directory) { m_replay_dir = directory; } // empty => no replay
+
+	private:
+		void on_packet(PacketReader& reader, const PacketHeader& header);
+		void start_game();
+		void on_action(const Action& action);
+		void play(const Action& action);
+		void play_opponent();
+		Action think(const GameState& view);
+		GameUpdate* acquire_update();
+		void publish_state(bool new_game);
+		void publish_delta(const std::array<std::uint8_t, BOARD_CELLS>& before, DIRECTION direction);
+
+		std::atomic<bool>* m_run;
+		AI m_ai;
+		double m_think_time; // seconds per action of the opponent
+		std::mt19937 m_rng;
+		AlphaBeta m_alpha_beta;
+		Mcts m_mcts;
+		GameState m_state;
+		std::string m_nickname;
+		int m_fruit; // fruit of the player, -1 if no game
+		std::uint32_t m_sequence;
+		std::uint32_t m_snapshot_version;
+		std::uint16_t m_ack;
+		std::string m_replay_dir;
+		ReplayWriter m_replay;
+		std::uint32_t m_games;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef MCTS_HPP
+#define MCTS_HPP
+
+#include <cstdint>
+#include <vector>
+#include <random>
+#include "rules.hpp"
+
+#define MCTS_MAX_NODES (1 << 18) // per thread, the tree stops growing when full and the playouts go on from its leaves
+
+// how the actions of a playout are chosen
+enum class PLAYOUT_POLICY
+{
+	RANDOM,		// uniform among every legal action, cards included
+	MOVES,		// uniform among the 4 moves, no card
+	GREEDY		// the move keeping the best fruit balance, ties broken at random, no card
+};
+
+struct MctsOptions
+{
+	int threads{ 0 }; // 0 => every core (omp_get_max_threads)
+	std::uint64_t playouts{ 0 }; // per search and for all threads together, 0 => only the time budget counts
+	double seconds{ 1.0 }; // time budget per search, 0 => only the playouts count (one of both must be set)
+	double exploration{ 1.4 }; // UCT constant
+	int playout_depth{ 60 }; // actions per playout before the position is evaluated
+	PLAYOUT_POLICY policy{ PLAYOUT_POLICY::GREEDY };
+	unsigned int seed{ 0 };
+};
+
+struct MctsResult
+{
+	Action action; // most visited action of the root
+	double value; // estimated chance of winning for the player to play
+	std::uint64_t playouts;
+	double time; // seconds
+	double playouts_per_second;
+	int threads;
+};
+
+// Monte Carlo tree search with root parallelization : every OpenMP thread grows its own tree from the root,
+// the visits of the root children are summed at the end. there is no lock during the search
+// the state given to search() should only hold what the player to play knows (see restrict_view)
+class Mcts
+{
+	public:
+		Mcts(const MctsOptions& options);
+		MctsResult search(const GameState& state);
+		const MctsOptions& options() const { return m_options; }
+
+	private:
+		struct Node
+		{
+			Action action; // action leading to this node
+			std::uint8_t mover; // fruit that played it
+			std::int32_t first_child; // -1 until expanded
+			std::int32_t child_count;
+			std::uint32_t visits;
+			float wins; // for the mover, a draw counts half
+		};
+
+		struct Tree
+		{
+			std::vector<Node> nodes; // nodes[0] is the root
+			std::vector<std::int32_t> path; // nodes visited by the current playout
+			std::mt19937 rng;
+			std::uint64_t playouts;
+		};
+
+		void grow(Tree& tree, const GameState& root) const; // selection, expansion, playout and backpropagation
+		float playout(GameState& state, std::mt19937& rng) const; // result for orange in [0, 1]
+		float evaluate(const GameState& state) const; // chance of winning for orange of an unfinished game
+
+		MctsOptions m_options;
+		std::vector<Tree> m_trees; // one per thread, kept to reuse their memory
+		std::uint64_t m_searches; // mixed into the seed, two searches do not replay the same playouts
+};
+
+#endif
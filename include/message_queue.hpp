@@ -0,0 +1,113 @@
+#ifndef MESSAGE_QUEUE_HPP
+#define MESSAGE_QUEUE_HPP
+
+#include <atomic>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <chrono>
+
+#define MESSAGE_CAPACITY 512
+
+enum class MESSAGE
+{
+	CONNECT,			// render thread => network thread : hello packet to send once connected
+	PACKET,				// both ways : encoded packet (see protocol.hpp)
+	CONNECTION_RESULT,	// network thread => render thread : "1" on success, "0" on failure
+	CHAT				// network thread => render thread : decoded chat line
+};
+
+// fixed size slot, messages are written in place so posting one never allocates
+struct Message
+{
+	void set(MESSAGE code, const std::uint8_t* data, std::size_t size)
+	{
+		m_code = code;
+		m_size = (size < MESSAGE_CAPACITY) ? static_cast<int>(size) : MESSAGE_CAPACITY;
+		if (m_size > 0)
+			std::memcpy(m_data.data(), data, m_size);
+	}
+
+	std::string_view view() const { return std::string_view(reinterpret_cast<const char*>(m_data.data()), m_size); }
+
+	MESSAGE m_code;
+	int m_size;
+	std::chrono::steady_clock::time_point m_time; // when the message was posted
+	std::array<std::uint8_t, MESSAGE_CAPACITY> m_data;
+};
+
+// bounded lock-free ring buffer, exactly one thread may produce and one thread may consume
+template <typename T, std::size_t N>
+class SPSCQueue
+{
+	static_assert(N > 0 && (N & (N - 1)) == 0, "SPSCQueue capacity must be a power of two");
+
+	public:
+		SPSCQueue() : m_head(0), m_tail(0) {}
+		SPSCQueue(const SPSCQueue<T, N>& queue) = delete;
+		SPSCQueue& operator=(const SPSCQueue<T, N>& queue) = delete;
+
+		// producer : returns the next free slot, or nullptr if the queue is full
+		T* acquire()
+		{
+			std::size_t tail{ m_tail.load(std::memory_order_relaxed) };
+			if (tail - m_head.load(std::memory_order_acquire) == N)
+				return nullptr;
+			return &m_slot[tail & (N - 1)];
+		}
+
+		// producer : publishes the slot returned by acquire()
+		void commit()
+		{
+			m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// consumer : returns the oldest slot, or nullptr if the queue is empty
+		T* front()
+		{
+			std::size_t head{ m_head.load(std::memory_order_relaxed) };
+			if (head == m_tail.load(std::memory_order_acquire))
+				return nullptr;
+			return &m_slot[head & (N - 1)];
+		}
+
+		// consumer : releases the slot returned by front()
+		void pop()
+		{
+			m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// approximate when called from a third thread
+		std::size_t size() const
+		{
+			return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+		}
+
+	private:
+		alignas(64) std::atomic<std::size_t> m_head; // next slot to read, only written by the consumer
+		alignas(64) std::atomic<std::size_t> m_tail; // next slot to write, only written by the producer
+		alignas(64) std::array<T, N> m_slot;
+};
+
+// copy a message into the next free slot, returns false if the queue is full
+template <std::size_t N>
+bool enqueue_message(SPSCQueue<Message, N>& queue, MESSAGE code, const std::uint8_t* data, std::size_t size)
+{
+	Message* slot{ queue.acquire() };
+	if (!slot)
+		return false;
+	slot->set(code, data, size);
+	slot->m_time = std::chrono::steady_clock::now();
+	queue.commit();
+	return true;
+}
+
+template <std::size_t N>
+bool enqueue_message(SPSCQueue<Message, N>& queue, MESSAGE code, std::string_view data = std::string_view())
+{
+	return enqueue_message(queue, code, reinterpret_cast<const std::uint8_t*>(data.data()), data.size());
+}
+
+#endif
@@ -3,8 +3,41 @@
 
 #include <iostream>
 #include <string>
+#include <cstdint>
+#include <cstddef>
 #include <exception>
+#include <vector>
+#include <array>
+#include <memory>
+#include <cstring>
 #include <enet/enet.h>
+#include "protocol.hpp"
+#include "network_stats.hpp"
+
+#define BATCH_CAPACITY 1024 // bytes, below the ENet MTU so a batch is never fragmented
+#define PACKET_POOL_SIZE 32
+
+// fixed set of batch buffers handed to ENet without copy (ENET_PACKET_FLAG_NO_ALLOCATE),
+// a buffer comes back to the pool when ENet destroys the packet, only used by the network thread
+class PacketPool
+{
+	public:
+		PacketPool();
+		std::uint8_t* acquire(); // nullptr if every buffer is in flight
+		void release(std::uint8_t* buffer);
+
+	private:
+		std::unique_ptr<std::uint8_t[]> m_storage;
+		std::vector<std::uint8_t*> m_free;
+};
+
+// packets posted during a frame, sent as one ENet packet per channel
+struct PacketBatch
+{
+	std::uint8_t* m_data; // pool buffer, or m_fallback when the pool is exhausted
+	std::size_t m_size;
+	std::array<std::uint8_t, BATCH_CAPACITY> m_fallback;
+};
 
 class NetworkClient
 {
@@ -15,14 +48,30 @@ class NetworkClient
 		bool disconnect();
 		bool has_received_data();
 		void print_data();
-		void send_data(std::string data);
+		void send_packet(const std::uint8_t* data, std::size_t size); // appended to the batch of its delivery class
+		void flush_batches(); // hands every pending batch to ENet, call once per frame before service()
 		int service();
+		void sample_stats(NetworkSample& sample); // fills the ENet statistics of the server connection
+		bool wait(enet_uint32 timeout); // sleeps until server traffic, a wake up or the timeout (ms), returns true if server data is pending
+		void wake_up(); // thread safe, interrupts a pending wait()
 
 	public:
 		ENetHost* m_client;
 		ENetAddress m_address; // IP & port of the server the client will connect to
 		ENetPeer* m_peer; // the server the client is connected to
 		ENetEvent m_event; // event received from the server
+
+	private:
+		void send_batch(DELIVERY delivery);
+		static void release_packet(ENetPacket* packet); // ENet free callback of pooled packets
+
+	private:
+		PacketPool m_pool;
+		std::array<PacketBatch, CHANNEL_COUNT> m_batch;
+		enet_uint32 m_last_received; // host byte counters at the previous sample
+		enet_uint32 m_last_sent;
+		ENetSocket m_wakeup; // loopback socket other threads write to in order to interrupt wait()
+		ENetAddress m_wakeup_address;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,149 @@
+#ifndef NETWORK_STATS_HPP
+#define NETWORK_STATS_HPP
+
+#include <array>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstddef>
+#include "message_queue.hpp"
+
+#define STATS_INTERVAL 0.25 // seconds between two samples taken by the network thread
+#define STATS_WINDOW 240 // samples kept by the rolling histograms, 1 minute at STATS_INTERVAL
+#define STATS_BINS 32
+
+// one measurement of the connection, taken by the network thread every STATS_INTERVAL
+struct NetworkSample
+{
+	double m_time; // seconds since the network thread started
+	std::uint32_t m_rtt; // ms, smoothed by ENet
+	std::uint32_t m_rtt_variance; // ms, jitter estimated by ENet
+	float m_packet_loss; // ratio in [0, 1]
+	std::uint32_t m_bytes_in; // since the previous sample
+	std::uint32_t m_bytes_out;
+	std::uint32_t m_queue_to_server; // messages waiting in g_msg2server_queue
+	std::uint32_t m_queue_to_client; // messages waiting in g_msg2client_queue
+	float m_send_latency; // ms, worst delay between a message being posted and sent since the previous sample
+};
+
+// what the renderer did during one frame, reported by the render thread
+struct RenderStats
+{
+	int m_draw_calls; // sprite batch draw calls
+	int m_atlas_pages; // textures of the UI atlas
+	int m_glyph_pages; // textures of the glyph cache of the text renderer
+};
+
+// histogram of the last N values, adding a value is O(1) : the oldest one leaves its bin
+// values above max_value are counted in the last bin
+template <std::size_t N, std::size_t BINS>
+class RollingHistogram
+{
+	public:
+		RollingHistogram(float max_value) :
+			m_max_value(max_value),
+			m_values{},
+			m_bins{},
+			m_head(0),
+			m_count(0),
+			m_sum(0.0)
+		{}
+
+		void add(float value)
+		{
+			if (m_count == N)
+			{
+				float oldest{ m_values[m_head] };
+				m_bins[bin(oldest)]--;
+				m_sum -= oldest;
+			}
+			else
+			{
+				m_count++;
+			}
+			m_values[m_head] = value;
+			m_bins[bin(value)]++;
+			m_sum += value;
+			m_head = (m_head + 1) % N;
+		}
+
+		// upper bound of the bin holding the p-th percentile, p in [0, 1]
+		float percentile(float p) const
+		{
+			if (m_count == 0)
+				return 0.0f;
+			std::size_t rank{ static_cast<std::size_t>(p * (m_count - 1)) };
+			std::size_t seen{ 0 };
+			for (std::size_t i{ 0 }; i < BINS; ++i)
+			{
+				seen += m_bins[i];
+				if (seen > rank)
+					return m_max_value * (i + 1) / BINS;
+			}
+			return m_max_value;
+		}
+
+		float mean() const { return (m_count > 0) ? static_cast<float>(m_sum / m_count) : 0.0f; }
+		float last() const { return (m_count > 0) ? m_values[(m_head + N - 1) % N] : 0.0f; }
+		std::size_t count() const { return m_count; }
+		float max_value() const { return m_max_value; }
+		// raw values in a ring, the oldest one is at offset() once the window is full (ImGui::PlotLines layout)
+		const float* values() const { return m_values.data(); }
+		int offset() const { return (m_count == N) ? static_cast<int>(m_head) : 0; }
+
+	private:
+		std::size_t bin(float value) const
+		{
+			if (value <= 0.0f)
+				return 0;
+			std::size_t i{ static_cast<std::size_t>(value / m_max_value * BINS) };
+			return (i < BINS) ? i : BINS - 1;
+		}
+
+		float m_max_value;
+		std::array<float, N> m_values;
+		std::array<int, BINS> m_bins;
+		std::size_t m_head;
+		std::size_t m_count;
+		double m_sum;
+};
+
+using StatsHistogram = RollingHistogram<STATS_WINDOW, STATS_BINS>;
+
+// aggregates the samples of the network thread and the client frame times, owned by the render thread
+class NetworkStats
+{
+	public:
+		NetworkStats();
+		void poll(); // consumes the samples posted by the network thread
+		void add_frame(float delta);
+		void add_render(const RenderStats& render);
+		bool open_csv(const std::string& path); // every sample received from now on is appended to the file
+		bool dump_csv(const std::string& path) const; // writes the samples currently in the window
+		void draw_overlay(); // ImGui window, to call between ImGui::NewFrame() and ImGui::Render()
+
+	private:
+		void write_csv_header(std::ostream& out) const;
+		void write_csv_line(std::ostream& out, const NetworkSample& sample) const;
+
+		StatsHistogram m_rtt;
+		StatsHistogram m_jitter;
+		StatsHistogram m_loss;
+		StatsHistogram m_rate_in;
+		StatsHistogram m_rate_out;
+		StatsHistogram m_queue_to_server;
+		StatsHistogram m_queue_to_client;
+		StatsHistogram m_send_latency;
+		StatsHistogram m_frame_time;
+		StatsHistogram m_draw_calls;
+		int m_atlas_pages;
+		int m_glyph_pages;
+		std::array<NetworkSample, STATS_WINDOW> m_history;
+		std::size_t m_history_head;
+		std::size_t m_history_count;
+		std::ofstream m_csv;
+};
+
+inline SPSCQueue<NetworkSample, 64> g_stats_queue; // produced by the network thread, consumed by the render thread
+
+#endif
@@ -0,0 +1,212 @@
+#ifndef PROTOCOL_HPP
+#define PROTOCOL_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <string_view>
+
+// about the wire format
+// every packet starts with a 4 bytes header : version (u8), type (u8), payload length (u16, little endian)
+// integers are little endian, strings are prefixed by their length (u8)
+// an ENet packet may carry several packets back to back, the payload length delimits them
+// a board cell is one byte : bits 0-1 => fruit (0 = none, 1 = orange, 2 = banane), bit 2 => petrified,
+// bit 3 => tile alive, bit 4 => trap (only sent to the player who laid it)
+// game states and deltas carry the turn effects of rules.hpp and the number of actions (moves and cards)
+// of the receiver the server processed, so the client knows which of its predicted actions are confirmed
+
+#define PROTOCOL_VERSION 6
+#define PACKET_HEADER_SIZE 4
+#define PACKET_MAX_SIZE 512
+#define NICKNAME_MAX_SIZE 32
+#define BOARD_CELLS 64
+
+#define CHANNEL_COUNT 2 // one ENet channel per delivery class
+
+#define CELL_FRUIT_MASK 0x03
+#define CELL_PETRIFIED 0x04
+#define CELL_ALIVE 0x08
+#define CELL_TRAP 0x10
+
+enum class PACKET : std::uint8_t
+{
+	HELLO,				// client => server : nickname and avatar
+	SEARCH_OPPONENT,	// client => server
+	STOP_SEARCH,		// client => server
+	GIVE_UP,			// client => server
+	MOVE,				// client => server : direction, the opponent gets the result in a BOARD_DELTA
+	CHAT,				// client <=> server : text
+	GAME_INIT,			// server => client : full game state of a new game
+	TYPING,				// client <=> server : 1 if the player started typing a chat message, 0 if stopped
+	BOARD_DELTA,		// server => client : changed cells since the previous board sequence number
+	SNAPSHOT_REQUEST,	// client => server : a board delta was missed, the full state is needed
+	GAME_STATE,			// server => client : full game state, same payload as GAME_INIT, answers SNAPSHOT_REQUEST and card plays
+	CARD,				// client => server : card and target cell
+	OPPONENT_LEFT,		// server => client : the opponent gave up or disconnected, the game is won
+	COUNT
+};
+
+// how a packet is delivered, every class has its own ENet channel so a retransmit in one class never
+// delays another (no head of line blocking between moves and chat)
+enum class DELIVERY : std::uint8_t
+{
+	RELIABLE_ORDERED,	// game actions and state, channel 0
+	RELIABLE_UNORDERED,	// chat and typing indicator, channel 1, only ordered with each other
+	COUNT
+};
+
+enum class DIRECTION : std::uint8_t
+{
+	UP,
+	DOWN,
+	RIGHT,
+	LEFT
+};
+
+// ordering of the card textures in game.hpp
+enum class CARD : std::uint8_t
+{
+	ENCLUME,
+	CELERITE,
+	CONFISCATION,
+	RENFORT,
+	DESORDRE,
+	PETRIFICATION,
+	VACHETTE,
+	CONVERSION,
+	CHARGE,
+	ENTRACTE,
+	SOLO,
+	PIEGE,
+	COUNT
+};
+
+struct PacketHeader
+{
+	std::uint8_t version;
+	PACKET type;
+	std::uint16_t size; // payload size
+};
+
+// avatar attributes, values match the Avatar enums ordering
+struct AvatarData
+{
+	std::uint8_t gender;
+	std::uint8_t hair;
+	std::uint8_t eyes;
+	std::uint8_t mouth;
+	std::uint8_t skin_color;
+	std::uint8_t hair_color;
+	std::uint8_t eyes_color;
+};
+
+class PacketWriter
+{
+	public:
+		PacketWriter(std::uint8_t* buffer, std::size_t capacity);
+		void begin(PACKET type);
+		std::size_t end(); // patches the payload length, returns the packet size or 0 on overflow
+		void write_u8(std::uint8_t value);
+		void write_u16(std::uint16_t value);
+		void write_u32(std::uint32_t value);
+		void write_bytes(const std::uint8_t* data, std::size_t size);
+		void write_string(std::string_view str);
+		void write_avatar(const AvatarData& avatar);
+		const std::uint8_t* data() const { return m_buffer; }
+		std::size_t size() const { return m_size; }
+
+	private:
+		std::uint8_t* m_buffer;
+		std::size_t m_capacity;
+		std::size_t m_size;
+		std::size_t m_start; // offset of the packet being written
+		bool m_overflow;
+};
+
+class PacketReader
+{
+	public:
+		PacketReader(const std::uint8_t* data, std::size_t size);
+		bool read_header(PacketHeader& header); // positions the reader on the payload, false if malformed or another version
+		std::uint8_t read_u8();
+		std::uint16_t read_u16();
+		std::uint32_t read_u32();
+		const std::uint8_t* read_bytes(std::size_t size);
+		std::string_view read_string(); // view into the packet data
+		AvatarData read_avatar();
+		bool ok() const { return !m_error; }
+		std::size_t remaining() const { return m_end - m_pos; }
+
+	private:
+		const std::uint8_t* m_data;
+		std::size_t m_pos;
+		std::size_t m_end;
+		bool m_error;
+};
+
+// game init payload, decoded once by the network thread and handed to the render thread as is
+struct GameSnapshot
+{
+	std::string_view opponent_name() const { return std::string_view(opponent_name_data.data(), opponent_name_size); }
+	void set_opponent_name(std::string_view name);
+
+	std::uint32_t version; // set by the receiver, increases with every snapshot, not sent on the wire
+	bool new_game; // set by the receiver, false when the snapshot only resynchronizes the current game
+	std::uint32_t sequence; // board sequence number, the next delta continues from it
+	std::uint8_t fruit; // 0 => orange, 1 => banane
+	std::uint8_t turn;
+	std::uint8_t effects; // see rules.hpp
+	std::uint8_t pending;
+	std::uint8_t solo; // BOARD_CELLS if none
+	std::uint16_t turn_count;
+	std::uint16_t ack; // actions of the receiver processed so far in this game
+	std::array<char, NICKNAME_MAX_SIZE> opponent_name_data;
+	std::uint8_t opponent_name_size;
+	AvatarData opponent_avatar;
+	std::uint16_t cards; // bit i set => card i in hand
+	std::array<std::uint8_t, BOARD_CELLS> board; // row major, row 0 is the top of the board
+};
+
+struct CellChange
+{
+	std::uint8_t index; // row * 8 + column
+	std::uint8_t cell;
+};
+
+// cells changed by one server update, applied on top of the board with the previous sequence number
+struct BoardDelta
+{
+	std::uint32_t sequence;
+	std::uint8_t turn;
+	std::uint8_t effects;
+	std::uint8_t pending;
+	std::uint8_t solo;
+	std::uint16_t turn_count;
+	std::uint16_t ack;
+	std::uint8_t direction; // DIRECTION of the move as played, by the fruit to play before the delta (animation)
+	std::uint8_t count;
+	std::array<CellChange, BOARD_CELLS> cells;
+};
+
+DELIVERY packet_delivery(PACKET type);
+
+// encoders return the packet size, or 0 if the buffer is too small
+std::size_t encode_hello(std::uint8_t* buffer, std::size_t capacity, std::string_view nickname, const AvatarData& avatar);
+std::size_t encode_command(std::uint8_t* buffer, std::size_t capacity, PACKET type); // packets without payload
+std::size_t encode_move(std::uint8_t* buffer, std::size_t capacity, DIRECTION direction);
+std::size_t encode_card(std::uint8_t* buffer, std::size_t capacity, CARD card, std::uint8_t target);
+std::size_t encode_chat(std::uint8_t* buffer, std::size_t capacity, std::string_view text);
+std::size_t encode_typing(std::uint8_t* buffer, std::size_t capacity, bool typing);
+std::size_t encode_game_init(std::uint8_t* buffer, std::size_t capacity, const GameSnapshot& init, PACKET type = PACKET::GAME_INIT); // or GAME_STATE
+std::size_t encode_board_delta(std::uint8_t* buffer, std::size_t capacity, const BoardDelta& delta);
+
+// decoders expect a reader positioned on the payload (see PacketReader::read_header)
+bool decode_hello(PacketReader& reader, std::string_view& nickname, AvatarData& avatar);
+bool decode_move(PacketReader& reader, DIRECTION& direction);
+bool decode_card(PacketReader& reader, CARD& card, std::uint8_t& target);
+bool decode_chat(PacketReader& reader, std::string_view& text);
+bool decode_typing(PacketReader& reader, bool& typing);
+bool decode_game_init(PacketReader& reader, GameSnapshot& init); // GAME_INIT and GAME_STATE, leaves init.version and init.new_game untouched
+bool decode_board_delta(PacketReader& reader, BoardDelta& delta);
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include "rules.hpp"
+
+// about the replay files
+// header : "FBRP", version (u8), plies between two keyframes (u16), nickname of orange and of banane (strings)
+// then records, one tag (u8) each, with the integers and strings of protocol.hpp :
+// KEYFRAME => ply (u32) and the full game state, written at ply 0 and every keyframe interval
+// ACTION => type, value and target (3 u8), one ply
+// CHAT => fruit of the sender (u8) and text, it happened after the actions written before it
+// END => winner (u8, see rules.hpp, 0xFF if the game was abandoned)
+// the writer streams the records, a game cut short still loads up to its last record
+// the loader replays every action, a file with an illegal one is rejected
+
+#define REPLAY_MAGIC "FBRP"
+#define REPLAY_VERSION 1
+#define REPLAY_KEYFRAME_INTERVAL 16
+#define REPLAY_EXTENSION ".fbr"
+
+enum class REPLAY_RECORD : std::uint8_t
+{
+	KEYFRAME,
+	ACTION,
+	CHAT,
+	END
+};
+
+// records a game as it is played, keeps its own copy of the state to write the keyframes
+class ReplayWriter
+{
+	public:
+		ReplayWriter();
+		~ReplayWriter(); // closes the file, the game counts as abandoned if it is not over
+		bool open(const std::string& path, const GameState& state, std::string_view orange, std::string_view banane,
+			int keyframe_interval = REPLAY_KEYFRAME_INTERVAL);
+		void action(const Action& action);
+		void chat(int fruit, std::string_view text);
+		void close();
+		bool is_open() const { return m_file.is_open(); }
+
+	private:
+		void keyframe();
+
+		std::ofstream m_file;
+		GameState m_state;
+		std::uint32_t m_ply;
+		int m_interval;
+};
+
+struct ReplayChat
+{
+	std::uint32_t ply; // actions played before the message
+	std::uint8_t fruit;
+	std::string text;
+};
+
+// a replay file loaded in memory, any ply is rebuilt from the keyframe before it and at most
+// keyframe interval - 1 actions
+class Replay
+{
+	public:
+		Replay();
+		bool load(const std::string& path);
+		bool seek(std::uint32_t ply, GameState& state) const; // state after the first ply actions
+		std::uint32_t plies() const { return static_cast<std::uint32_t>(m_actions.size()); }
+		const Action& action(std::uint32_t ply) const { return m_actions[ply]; } // action played from ply
+		const std::vector<ReplayChat>& chats() const { return m_chats; }
+		const std::string& name(int fruit) const { return m_names[fruit]; }
+		int result() const { return m_result; } // winner(), -1 if abandoned or cut short
+		int keyframe_interval() const { return m_interval; }
+
+	private:
+		std::vector<std::uint8_t> m_data;
+		std::vector<std::size_t> m_keyframes; // offset in m_data of the state of each keyframe
+		std::vector<Action> m_actions;
+		std::vector<ReplayChat> m_chats;
+		std::string m_names[2];
+		int m_result;
+		int m_interval;
+};
+
+#endif
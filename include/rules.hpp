@@ -0,0 +1,93 @@
+#ifndef RULES_HPP
+#define RULES_HPP
+
+#include <cstdint>
+#include <array>
+#include <random>
+#include <string>
+#include "protocol.hpp"
+#include "bitboard.hpp"
+
+// about the rules
+// the players take turns, orange starts. during its turn a player may play one card of its hand, then moves
+// all its free bandas one cell in a direction (see BitBoard::push). every SHRINK_PERIOD turns the border of the
+// board falls with whatever stands on it. a player without free bandas loses, both at once is a draw
+// the same code runs on the server (authoritative) and on the client (prediction), it only depends on the state
+
+#define CARD_COUNT 12
+#define HAND_SIZE 3
+#define SHRINK_PERIOD 10 // turns between two collapses of the border
+#define RENFORT_COUNT 3
+#define NO_CELL BOARD_CELLS
+#define MAX_ACTIONS (4 + CARD_COUNT * BOARD_CELLS) // any hand, a card has at most one action per cell
+
+// effects of the cards played, they concern the player to play
+#define EFFECT_CELERITE 0x01 // one more move after the current one
+#define EFFECT_CHARGE 0x02 // the bandas move 2 cells
+#define EFFECT_DESORDRE 0x04 // the moves are reversed
+#define EFFECT_CONFISCATION 0x08 // the card played goes to the opponent without effect
+#define EFFECT_CARD_PLAYED 0x10 // no more card this turn
+#define EFFECT_MOVED 0x20 // the first move of the turn is done, no more card
+
+enum class ACTION : std::uint8_t
+{
+	MOVE,
+	CARD
+};
+
+struct Action
+{
+	ACTION type;
+	std::uint8_t value; // DIRECTION or CARD
+	std::uint8_t target; // cell index, NO_CELL for moves and cards without target (vachette uses the column of the cell)
+};
+
+// the pushes of a move, one per step (a charge moves twice), enough to animate it
+struct MoveSteps
+{
+	DIRECTION direction; // after desordre
+	int count;
+	std::array<PushResult, 2> push;
+};
+
+struct GameState
+{
+	BitBoard m_board;
+	std::array<Bitboard, 2> m_trap; // traps laid by each fruit, m_board.m_trap is their union
+	std::array<std::uint16_t, 2> m_cards; // hand of each fruit, bit i => card i
+	std::uint8_t m_turn; // fruit to play
+	std::uint8_t m_effects; // EFFECT_ bits of the current turn
+	std::uint8_t m_pending; // EFFECT_ bits given to the opponent for its next turn (desordre, confiscation)
+	std::uint8_t m_solo; // cell of the only bandas moving this turn, NO_CELL if none
+	std::uint16_t m_turn_count;
+	std::uint64_t m_hash; // zobrist hash of everything above, kept up to date by the functions below
+};
+
+// cells use the wire encoding of protocol.hpp
+void init_state(GameState& state, const std::array<std::uint8_t, BOARD_CELLS>& cells, std::uint16_t orange_cards, std::uint16_t banane_cards);
+// random board of 32 oranges and 32 bananas on alive tiles, three distinct cards per player
+void deal_state(GameState& state, std::mt19937& rng);
+// the client only knows its hand and its traps
+void load_state(GameState& state, const GameSnapshot& snapshot);
+void patch_state(GameState& state, const BoardDelta& delta, int viewer);
+// board, hand and turn effects as seen by viewer, the rest of the snapshot is left untouched
+void store_state(const GameState& state, int viewer, GameSnapshot& snapshot);
+void restrict_view(GameState& state, int viewer); // removes the traps and the hand of the opponent
+std::uint8_t visible_cell(const GameState& state, int index, int viewer); // hides the traps of the opponent
+void visible_cells(const GameState& state, int viewer, std::array<std::uint8_t, BOARD_CELLS>& cells);
+
+bool card_needs_target(CARD card);
+bool is_legal(const GameState& state, const Action& action); // for the player to play
+int generate_actions(const GameState& state, std::array<Action, MAX_ACTIONS>& actions); // every legal action, moves first
+// the action must be legal, returns the fruits moved and killed by a move (both empty for a card)
+// steps, if given, receives every push of a move (count 0 for a card)
+PushResult apply_action(GameState& state, const Action& action, MoveSteps* steps = nullptr);
+int winner(const GameState& state); // -1 => game running, 0 => orange, 1 => banane, 2 => draw
+// 8 lines of 8 characters for the headless tools : 'x' no tile, '.' empty tile, 'o' orange, 'b' banane,
+// 'O' / 'B' petrified orange / banane, '1' / '2' trap of orange / banane
+std::string board_text(const GameState& state);
+// from scratch, apply_action only xors the keys of what it changed. the keys are the same on every machine
+// so the hash also identifies a position in the replays and the opening statistics
+std::uint64_t compute_hash(const GameState& state);
+
+#endif
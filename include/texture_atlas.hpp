@@ -0,0 +1,69 @@
+#ifndef TEXTURE_ATLAS_HPP
+#define TEXTURE_ATLAS_HPP
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// about the atlas
+// the images of the UI directories are packed in a few large textures (pages) with the rectangle packer
+// of stb (imstb_rectpack.h), the sprites then reference a sub-rectangle of a page and a whole page of the
+// UI draws without texture switch, see SpriteBatch
+// the first launch writes the packed pages to the cache file along with the size and date of every image,
+// the next launches upload the cached pages unless an image was added, removed or modified
+// an image outside of the atlas directories still works, it is loaded on its own texture the first time
+// cache : "FBAT", version (u32), page size (u32), number of images (u32)
+// then per image : path (u16 length and characters), file size (u64), file date (i64), page (i32), x, y, w, h (u16)
+// then number of pages (u32) and per page : width, height (u32) and the RGBA texels, bottom row first
+// integers are written in the byte order of the machine, the cache is never shared
+
+#define ATLAS_PAGE_SIZE 4096 // lowered to GL_MAX_TEXTURE_SIZE if needed
+#define ATLAS_PADDING 1 // border texels repeated around every image, linear filtering does not bleed on the neighbours
+#define ATLAS_CACHE_FILE "ui_atlas.cache"
+#define ATLAS_CACHE_MAGIC "FBAT"
+#define ATLAS_CACHE_VERSION 1
+
+struct AtlasRegion
+{
+	GLuint texture{ 0 }; // 0 => no image
+	glm::vec4 tex_rect{ 0.0f, 0.0f, 1.0f, 1.0f }; // bottom left and top right texture coordinates
+};
+
+// an image of the atlas, where it is packed
+struct AtlasImage
+{
+	std::string path;
+	std::uint64_t file_size;
+	std::int64_t file_time;
+	int page; // -1 => too large for a page, loaded on its own texture
+	int x, y, w, h; // texels of the page, padding excluded
+};
+
+class TextureAtlas
+{
+	public:
+		TextureAtlas();
+		~TextureAtlas();
+		TextureAtlas(const TextureAtlas&) = delete;
+		TextureAtlas& operator=(const TextureAtlas&) = delete;
+		// packs every .tga of the directories (not their sub-directories), or loads the cache if it is up to date
+		void build(const std::vector<std::string>& directories, const std::string& cache_path);
+		const AtlasRegion& get(const std::string& path);
+		int get_page_count() const { return static_cast<int>(m_pages.size()); }
+
+	private:
+		bool load_cache(const std::string& cache_path, std::vector<AtlasImage>& images, int page_size);
+		void pack(std::vector<AtlasImage>& images, int page_size, const std::string& cache_path);
+		void upload_page(int width, int height, const std::uint8_t* texels);
+		void add_regions(const std::vector<AtlasImage>& images);
+
+		std::vector<GLuint> m_pages;
+		std::vector<glm::ivec2> m_page_size;
+		std::vector<GLuint> m_loose; // textures of the images outside of the atlas
+		std::unordered_map<std::string, AtlasRegion> m_regions;
+};
+
+#endif
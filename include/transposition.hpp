@@ -0,0 +1,59 @@
+#ifndef TRANSPOSITION_HPP
+#define TRANSPOSITION_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include "rules.hpp"
+
+#define TT_DEFAULT_MB 16
+
+enum class BOUND : std::uint8_t
+{
+	NONE,
+	EXACT,
+	LOWER, // the score is at least this one (cutoff)
+	UPPER // the score is at most this one (no action reached alpha)
+};
+
+struct TTEntry
+{
+	std::int32_t score;
+	std::uint8_t depth;
+	BOUND bound;
+	bool has_action;
+	Action action; // best action found, searched first the next time
+};
+
+// fixed size table of positions searched, indexed by GameState::m_hash
+// lock free : an entry is two 64 bits words, the key is stored xored with the data so a read racing a write
+// of another thread sees a key that does not match instead of mixing two positions (no lock, no torn entry)
+// buckets of 2 entries : the first one keeps the deepest search of the current generation, the second one
+// always takes the newest position. the table never grows, older positions are overwritten
+class TranspositionTable
+{
+	public:
+		TranspositionTable(std::size_t megabytes = TT_DEFAULT_MB);
+		bool probe(std::uint64_t key, TTEntry& entry) const;
+		void store(std::uint64_t key, const TTEntry& entry);
+		void new_search(); // entries of the previous searches become the first to be replaced
+		void clear();
+		std::size_t size() const { return m_bucket_count * 2; }
+
+	private:
+		struct Slot
+		{
+			std::atomic<std::uint64_t> m_key; // key ^ data
+			std::atomic<std::uint64_t> m_data;
+		};
+
+		static std::uint64_t pack(const TTEntry& entry, std::uint8_t generation);
+		static TTEntry unpack(std::uint64_t data);
+
+		std::unique_ptr<Slot[]> m_slots;
+		std::size_t m_bucket_count; // power of 2
+		std::atomic<std::uint8_t> m_generation; // 6 bits, bumped by new_search
+};
+
+#endif
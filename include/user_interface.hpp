@@ -10,68 +10,190 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include <map>
+#include <unordered_map>
+#include <functional>
 #include <vector>
 #include <array>
 #include <exception>
 #include "shader_light.hpp"
+#include "texture_atlas.hpp"
 
 
+// about the glyph cache
+// a glyph is rasterized with FreeType the first time it is printed or measured, then copied in a page of the cache
+// pages are GL_RED textures of GLYPH_ATLAS_SIZE texels filled shelf after shelf, they are shared by every police
+// when no page has room left, the page drawn the longest time ago is emptied and its glyphs are rasterized again
+// when they are printed, the pages of the string being printed are never emptied
+// the metrics of ASCII characters are kept in a flat array, the other code points in a map which only keeps
+// the glyphs still in a page (and at most GLYPH_CACHE_SIZE blank or evicted ones)
+#define GLYPH_ATLAS_SIZE 512 // texels, side of a page of the glyph cache
+#define GLYPH_ATLAS_PAGES 4 // pages of the glyph cache, 1 MB of texture memory
+#define GLYPH_PADDING 1 // empty texels between two glyphs of a page
+#define GLYPH_CACHE_SIZE 1024 // non ASCII glyphs kept per police outside of the pages
+#define TEXT_BATCH_GLYPHS 64 // initial capacity of the vertex buffer, it grows for longer strings
+#define TEXT_LAYOUT_CACHE_SIZE 256 // laid out strings kept, the cache is emptied when it is full
+
+// UTF-8, an invalid byte is read as U+FFFD and skipped
+char32_t utf8_decode(const std::string& txt, std::size_t& i); // code point at i, i moves to the next one
+std::size_t utf8_next(const std::string& txt, std::size_t i); // start of the character after the one at i
+std::size_t utf8_previous(const std::string& txt, std::size_t i); // start of the character before i
+
 struct Glyph
 {
-    GLuint textureID; // handle of the glyph texture
+    glm::vec4 tex_rect; // texture coordinates of the top left and bottom right corners in its page
     glm::ivec2 size; // size of glyph
     glm::ivec2 bearing; // offset from baseline to left/top of glyph
     int advance; // offset to advance to next glyph
+    int page{ -1 }; // page of the glyph cache, -1 => blank or evicted
+    bool loaded{ false }; // metrics read from the font
+};
+
+// position of the characters of a string printed at x = 0
+struct TextLayout
+{
+    std::vector<float> pen; // pen[i] => left of the i-th character, pen.back() => width of the string
+    std::vector<int> offset; // offset[i] => first byte of the i-th character, offset.back() => size of the string
 };
 
 class Text
 {
     public:
-        using Alphabet = std::map<char, Glyph>;
+        using Alphabet = std::array<Glyph, 128>; // indexed by ASCII character
+
+        struct Police
+        {
+            std::string file;
+            FT_Face face; // kept open, glyphs are rasterized when they are first needed
+            Alphabet alphabet;
+            std::unordered_map<char32_t, Glyph> extended; // code points above 127 already met
+            float height; // height of the tallest ASCII glyph, the cursor height
+            float descent; // lowest bottom of an ASCII glyph under the baseline (negative)
+        };
+
+        struct GlyphPage
+        {
+            GLuint texture;
+            glm::ivec2 shelf; // next free texel of the current shelf
+            int shelfHeight; // tallest glyph of the current shelf
+            unsigned int lastUse; // print call which last drew from the page
+        };
 
     public:
         Text(int width, int height);
         ~Text();
+        Text(const Text&) = delete;
+        Text& operator=(const Text&) = delete;
         void init();
         void resize_screen(int width, int height);
         void load_police(std::string ttf_file, int font_size);
         void use_police(int index);
-        void print(std::string txt, float x, float y, float scale, glm::vec3 color);
-        glm::vec3 get_cursor_shape(std::string txt, float x, float y, float scale, int cursor_pos); // x,y => pos, z => height
+        void print(std::string txt, float x, float y, float scale, glm::vec3 color); // UTF-8, one draw call per page of the glyph cache used
+        glm::vec3 get_cursor_shape(const std::string& txt, float x, float y, float scale, int cursor_pos); // cursor_pos in bytes, x,y => pos, z => height
+        int get_cursor_pos(const std::string& txt, float x, float scale, float mouseX); // first byte of the character boundary nearest to mouseX
+        int get_page_count() const { return static_cast<int>(pages.size()); }
 
     private:
+        struct LayoutKey
+        {
+            std::string txt;
+            int police;
+            float scale;
+            bool operator==(const LayoutKey& other) const { return police == other.police && scale == other.scale && txt == other.txt; }
+        };
+
+        struct LayoutKeyHash
+        {
+            std::size_t operator()(const LayoutKey& key) const
+            {
+                return std::hash<std::string>()(key.txt) ^ (std::hash<int>()(key.police) * 31) ^ (std::hash<float>()(key.scale) * 131);
+            }
+        };
+
+        const TextLayout& get_layout(const std::string& txt, float scale); // with the active police
+        const Glyph& get_glyph(Police& font, char32_t code); // rasterized and cached if needed
+        void rasterize(Police& font, char32_t code, Glyph& glyph);
+        int allocate(int w, int h, glm::ivec2& pos); // page with room for w x h texels, -1 => every page is in use
+        void evict(int index);
+
         FT_Library ft;
-        std::vector<std::pair<std::string, Alphabet>> police;
+        std::vector<Police> police;
         int activePoliceIndex;
+        std::vector<GlyphPage> pages;
+        unsigned int printCount;
+        std::vector<unsigned char> bitmap; // rows of the glyph being copied in a page
+        std::vector<const Glyph*> glyphs; // glyphs of the string being printed
         GLuint vao;
         GLuint vbo;
+        std::size_t vboCapacity; // floats
+        std::vector<float> vertices; // quads of the string being printed, kept to reuse its memory
+        std::unordered_map<LayoutKey, TextLayout, LayoutKeyHash> layouts; // strings already laid out
         Shader shader;
         glm::mat4 projection;
 };
 
+#define SPRITE_BATCH_QUADS 256 // initial capacity of the batch, it grows if a frame needs more
+
+struct SpriteVertex
+{
+    glm::vec2 pos;
+    glm::vec2 tex_coords;
+    glm::vec4 color; // tint of the image, or plain color
+    float bloom_strength;
+    float textured; // 0 => plain color
+};
+
+// every sprite of a frame goes through one shader program and one streaming vertex buffer
+// quads are drawn in the order they were added, a draw call is only issued when the texture changes
+// or when flush() is called, before drawing anything that does not go through the batch (text, cursor, mouse)
+class SpriteBatch
+{
+    public:
+        SpriteBatch(int screenW, int screenH);
+        ~SpriteBatch();
+        SpriteBatch(const SpriteBatch&) = delete;
+        SpriteBatch& operator=(const SpriteBatch&) = delete;
+        void resize_screen(int width, int height);
+        // rect => x, y of the bottom left and top right corners, tex_rect => same for the texture coordinates
+        // texture 0 => plain color quad, it fits in any batch
+        void add_quad(glm::vec4 rect, glm::vec4 tex_rect, GLuint texture, glm::vec4 color, float bloom_strength);
+        void flush();
+        int get_draw_calls() const { return m_draw_calls; } // since the last call to reset_stats()
+        void reset_stats() { m_draw_calls = 0; }
+
+    private:
+        std::vector<SpriteVertex> m_vertices;
+        GLuint m_texture; // texture of the quads waiting in m_vertices, 0 => none yet
+        GLuint m_vao;
+        GLuint m_vbo;
+        std::size_t m_capacity; // vertices the vbo can hold
+        int m_draw_calls;
+        Shader m_shader;
+        glm::mat4 m_projection;
+};
+
 class Sprite
 {
     public:
-        Sprite(int id, glm::vec2 pos, glm::vec2 size, int screenW, int screenH);
-        ~Sprite();
+        Sprite(int id, glm::vec2 pos, glm::vec2 size);
         int get_id() { return m_id; }
         void translate(glm::vec2 shift);
         void set_pos(glm::vec2 pos);
         void set_size(glm::vec2 size);
         glm::vec2 get_position() { return m_pos; }
         glm::vec2 get_size() { return m_size; }
-        void set_background_img(std::string img);
-        void set_background_img_gl(GLuint id) { m_img_gl = id; }
-        void set_background_img_selected(std::string img);
+        void set_background_img(const AtlasRegion& img) { m_img[0] = img; }
+        void set_background_img_gl(GLuint id) { m_img_gl = AtlasRegion{ id }; } // whole texture, a framebuffer attachment for instance
+        void set_background_img_gl(const AtlasRegion& img) { m_img_gl = img; }
+        void set_background_img_selected(const AtlasRegion& img) { m_img[1] = img; }
         void set_background_color(glm::vec4 color) { m_color = color; }
         void set_bloom_strength(float strength) { m_bloom_strength = strength; }
-        void draw(glm::vec2 translate = glm::vec2(0.0f));
+        void set_opacity(float opacity) { m_opacity = opacity; } // multiplies the alpha of the sprite
+        void draw(SpriteBatch& batch, glm::vec2 translate = glm::vec2(0.0f));
         void use_background_img() { m_img_index = 0; }
         void use_background_img_gl() { m_img_index = -2; }
         void use_background_img_selected() { m_img_index = 1; }
         void use_background_color() { m_img_index = -1; }
         bool mouse_hover(int mouseX, int mouseY);
-        void resize_screen(int width, int height);
         void set_selectable(bool selectable) { m_selectable = selectable; }
         bool is_selectable() { return m_selectable; }
         void select() { m_selected = true; }
@@ -86,15 +208,13 @@ class Sprite
         int m_layer_id;
         glm::vec2 m_pos; // top left corner position
         glm::vec2 m_size;
-        GLuint m_vao;
-        GLuint m_vbo;
-        std::array<Texture, 2> m_img; // [0] = normal, [1] = selected
-        GLuint m_img_gl;
+        glm::vec4 m_quad; // bottom left and top right corners of the drawn quad
+        std::array<AtlasRegion, 2> m_img; // [0] = normal, [1] = selected, the textures belong to the atlas
+        AtlasRegion m_img_gl;
         glm::vec4 m_color;
         int m_img_index; // -1 means it uses plain color, -2 means it uses a framebuffer color texture
         float m_bloom_strength;
-        Shader m_shader;
-        glm::mat4 m_projection;
+        float m_opacity;
         bool m_selectable;
         bool m_selected;
 };
@@ -127,9 +247,9 @@ struct Layer
     
     void set_visibility(bool visible) { m_visible = visible; }
     
-    void add_sprite(int id, glm::vec2 pos, glm::vec2 size, int screenW, int screenH)
+    void add_sprite(int id, glm::vec2 pos, glm::vec2 size)
     {
-        m_sg.m_sprite.emplace_back(std::make_shared<Sprite>(id, pos, size, screenW, screenH));
+        m_sg.m_sprite.emplace_back(std::make_shared<Sprite>(id, pos, size));
         m_sg.m_sprite[m_sg.m_sprite.size() - 1]->set_layer_id(m_id);
     }
 
@@ -143,12 +263,12 @@ struct Layer
         throw std::exception("Error while fetching sprite : wrong ID");
     }
 
-    void draw()
+    void draw(SpriteBatch& batch)
     {
         if (!m_visible)
             return;
         for (auto& sprite : m_sg.m_sprite)
-            sprite->draw();
+            sprite->draw(batch);
     }
 
     int m_id;
@@ -171,10 +291,10 @@ struct Page
         }
         throw std::exception("Error while fetching layer : wrong ID");
     }
-    void draw()
+    void draw(SpriteBatch& batch)
     {
         for (auto& layer : m_layer)
-            layer.draw();
+            layer.draw(batch);
     }
 
     int m_id;
@@ -184,7 +304,10 @@ struct Page
 class UI
 {
     public:
-        UI() : m_page_index(-1) {}
+        UI(int screenW, int screenH) : m_page_index(-1), m_batch(screenW, screenH)
+        {
+            m_atlas.build({ "assets", "assets/avatar", "assets/cartes" }, ATLAS_CACHE_FILE);
+        }
 
         int get_active_page() { return m_page_index; }
 
@@ -217,23 +340,27 @@ class UI
 
         Page& get_page(int index) { return m_page[index]; }
 
+        SpriteBatch& get_batch() { return m_batch; }
+
+        TextureAtlas& get_atlas() { return m_atlas; }
+
+        // queues the sprites of the active page, they are drawn by the next flush of the batch
+        void draw()
+        {
+            if (m_page_index != -1)
+                m_page[m_page_index].draw(m_batch);
+        }
+
         void resize_screen(int width, int height)
         {
-            for (auto& page : m_page)
-            {
-                for (auto& layer : page.m_layer)
-                {
-                    for (auto& sprite : layer.m_sg.m_sprite)
-                    {
-                        sprite->resize_screen(width, height);
-                    }
-                }
-            }
+            m_batch.resize_screen(width, height);
         }
 
     private:
         std::vector<Page> m_page;
         int m_page_index; // active page (rendered)
+        SpriteBatch m_batch;
+        TextureAtlas m_atlas;
 };
 
 #endif
@@ -10,6 +10,7 @@
 #include <omp.h>
 #include <cmath>
 #include <memory>
+#include <atomic>
 #include "color.hpp"
 
 #include "imgui.h"
@@ -50,9 +51,11 @@ class WindowManager
 		std::array<int, 3> & getMouseData();
 		std::bitset<10>& getUserInputs();
 		char* get_text_input();
-		bool& isAlive();
+		std::atomic<bool>& isAlive();
 		void checkEvents(bool writing = false);
 		void resetEvents();
+		bool show_stats_overlay() const { return m_stats_overlay; }
+		void set_stats_overlay(bool show) { m_stats_overlay = show; }
 
 	private:
 
@@ -61,7 +64,7 @@ class WindowManager
 		std::string title;
 		int width;
 		int height;
-		bool alive;
+		std::atomic<bool> alive; // read by the network thread
 
 		SDL_Window * window;
 		SDL_GLContext glContext;
@@ -70,6 +73,7 @@ class WindowManager
 		std::array<int, 3> mouseData; // 0 = xRel, 1 = yRel, 2 = mouse wheel direction
 		std::bitset<10> userInputs;
 		char m_textInput[32];
+		bool m_stats_overlay; // network telemetry, toggled with F3
 };
 
 #endif
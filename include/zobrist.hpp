@@ -0,0 +1,68 @@
+#ifndef ZOBRIST_HPP
+#define ZOBRIST_HPP
+
+#include <cstdint>
+#include <array>
+#include "protocol.hpp"
+
+// about the zobrist keys
+// a position hash is the xor of one random key per feature present : tile alive, orange, banane, stone,
+// trap of each fruit on every cell, every card in each hand, the fruit to play, the turn effects, the solo cell
+// and the number of turns before the border falls. an action xors out the keys of the features it changed,
+// so updating the hash costs O(changed features), see hash_difference in rules.cpp
+
+#define ZOBRIST_SEED 0x9E3779B97F4A7C15ULL
+
+enum class PLANE : std::uint8_t
+{
+	ALIVE,
+	ORANGE,
+	BANANE,
+	PETRIFIED,
+	TRAP_ORANGE,
+	TRAP_BANANE,
+	COUNT
+};
+
+struct ZobristKeys
+{
+	std::array<std::array<std::uint64_t, BOARD_CELLS>, static_cast<int>(PLANE::COUNT)> cell;
+	std::array<std::array<std::uint64_t, 16>, 2> card; // hand of each fruit
+	std::uint64_t banane_to_play;
+	std::array<std::uint64_t, 8> effect; // one per EFFECT_ bit of the player to play
+	std::array<std::uint64_t, 8> pending;
+	std::array<std::uint64_t, BOARD_CELLS + 1> solo;
+	std::array<std::uint64_t, 32> shrink_phase; // turn count modulo SHRINK_PERIOD
+
+	ZobristKeys()
+	{
+		// splitmix64, fixed seed so the hashes are the same on every machine (replays, opening statistics)
+		std::uint64_t state{ ZOBRIST_SEED };
+		auto next = [&state]()
+		{
+			std::uint64_t z{ state += 0x9E3779B97F4A7C15ULL };
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+			return z ^ (z >> 31);
+		};
+		for (auto& plane : cell)
+			for (auto& key : plane)
+				key = next();
+		for (auto& hand : card)
+			for (auto& key : hand)
+				key = next();
+		banane_to_play = next();
+		for (auto& key : effect)
+			key = next();
+		for (auto& key : pending)
+			key = next();
+		for (auto& key : solo)
+			key = next();
+		for (auto& key : shrink_phase)
+			key = next();
+	}
+};
+
+inline const ZobristKeys g_zobrist;
+
+#endif
@@ -4,21 +4,21 @@ layout (location = 0) out vec4 color;
 layout (location = 1) out vec4 brightColor;
 
 in vec2 texCoords;
+in vec4 tint;
+flat in float bloomStrength;
+flat in float textured;
 
 uniform sampler2D image;
-uniform vec4 bkg_color;
-uniform bool use_bkg_img;
-uniform float bloom_strength;
 
 void main()
 {
-    if(use_bkg_img)
-        color = texture(image, texCoords);
+    if(textured > 0.5f)
+        color = texture(image, texCoords) * tint;
     else
-        color = bkg_color;
+        color = tint;
 
     // bright color
-    float brightness = dot(color.rgb*bloom_strength, vec3(0.2126f, 0.7152f, 0.0722f));
+    float brightness = dot(color.rgb*bloomStrength, vec3(0.2126f, 0.7152f, 0.0722f));
     if(brightness > 1.0f)
         brightColor = color;
     else
@@ -2,14 +2,21 @@
 
 layout (location = 0) in vec2 aPos;
 layout (location = 1) in vec2 aTex;
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec2 aParams; // x => bloom strength, y => 1 if the quad samples the image
 
 out vec2 texCoords;
+out vec4 tint;
+flat out float bloomStrength;
+flat out float textured;
 
 uniform mat4 proj;
-uniform vec2 translate;
 
 void main()
 {
-	gl_Position = proj * vec4(aPos + translate, 0.0f, 1.0f);
+	gl_Position = proj * vec4(aPos, 0.0f, 1.0f);
     texCoords = aTex;
+    tint = aColor;
+    bloomStrength = aParams.x;
+    textured = aParams.y;
 }
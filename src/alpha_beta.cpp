@@ -0,0 +1,242 @@
+#include "alpha_beta.hpp"
+#include <algorithm>
+
+#define NODES_PER_CLOCK_CHECK 1024
+
+AlphaBeta::AlphaBeta(std::size_t table_megabytes) :
+	m_root(0),
+	m_abort(false),
+	m_nodes(0),
+	m_killer{},
+	m_history{},
+	m_table(table_megabytes)
+{}
+
+SearchResult AlphaBeta::search(const GameState& state, double seconds)
+{
+	auto start{ std::chrono::steady_clock::now() };
+	m_deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+	m_root = state.m_turn;
+	m_abort = false;
+	m_nodes = 0;
+	for (auto& killer : m_killer)
+		killer.fill(Action{ ACTION::MOVE, 0xFF, NO_CELL });
+	// older cutoffs count less than the ones of this search
+	for (int& h : m_history)
+		h /= 8;
+	m_table.new_search();
+
+	SearchResult result{ Action{ ACTION::MOVE, static_cast<std::uint8_t>(DIRECTION::UP), NO_CELL }, 0, 0, 0, 0.0 };
+	std::array<Action, MAX_ACTIONS> actions;
+	int count{ generate_actions(state, actions) };
+	if (count == 0)
+		return result;
+	result.action = actions[0];
+	// the action found for this position by an earlier search (often the one before the last two plies)
+	TTEntry entry;
+	bool hinted{ false };
+	if (m_table.probe(state.m_hash, entry) && entry.has_action)
+	{
+		for (int i{ 0 }; i < count && !hinted; ++i)
+		{
+			hinted = actions[i].type == entry.action.type && actions[i].value == entry.action.value && actions[i].target == entry.action.target;
+		}
+		if (hinted)
+			result.action = entry.action;
+	}
+
+	for (int depth{ 1 }; depth <= AI_MAX_DEPTH; ++depth)
+	{
+		// the best action of the previous iteration is searched first, it gives the tightest window
+		order(actions, count, 0, (depth > 1 || hinted) ? &result.action : nullptr);
+		int alpha{ -AI_INFINITY };
+		Action best{ actions[0] };
+		for (int i{ 0 }; i < count; ++i)
+		{
+			GameState child{ state };
+			apply_action(child, actions[i]);
+			// the root player maximizes whether or not the action ends its turn
+			int score{ alpha_beta(child, depth - 1, 1, alpha, AI_INFINITY) };
+			if (m_abort)
+				break;
+			if (score > alpha)
+			{
+				alpha = score;
+				best = actions[i];
+			}
+		}
+		if (m_abort)
+			break;
+		result.action = best;
+		result.score = alpha;
+		result.depth = depth;
+		m_table.store(state.m_hash, TTEntry{ to_table(alpha, 0), static_cast<std::uint8_t>(depth), table_bound(BOUND::EXACT), true, best });
+		// a forced result does not change with more depth
+		if (alpha >= AI_WIN - AI_MAX_DEPTH || alpha <= -AI_WIN + AI_MAX_DEPTH)
+			break;
+	}
+	result.nodes = m_nodes;
+	result.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+int AlphaBeta::alpha_beta(const GameState& state, int depth, int ply, int alpha, int beta)
+{
+	if ((++m_nodes % NODES_PER_CLOCK_CHECK) == 0 && std::chrono::steady_clock::now() >= m_deadline)
+	{
+		m_abort = true;
+	}
+	if (m_abort)
+		return 0;
+
+	int result{ winner(state) };
+	if (result != -1)
+		return (result == 2) ? 0 : ((result == m_root) ? AI_WIN - ply : -AI_WIN + ply);
+	if (depth == 0 || ply >= AI_MAX_DEPTH)
+		return evaluate(state);
+
+	// a bound good enough for this depth ends the search of the position, otherwise its action is tried first
+	TTEntry entry;
+	Action hint;
+	bool hinted{ false };
+	if (m_table.probe(state.m_hash, entry))
+	{
+		hinted = entry.has_action;
+		hint = entry.action;
+		if (entry.depth >= depth)
+		{
+			int score{ from_table(entry.score, ply) };
+			BOUND bound{ table_bound(entry.bound) };
+			if (bound == BOUND::EXACT)
+				return score;
+			if (bound == BOUND::LOWER)
+				alpha = std::max(alpha, score);
+			else if (bound == BOUND::UPPER)
+				beta = std::min(beta, score);
+			if (alpha >= beta)
+				return score;
+		}
+	}
+	int window_alpha{ alpha }, window_beta{ beta };
+
+	std::array<Action, MAX_ACTIONS> actions;
+	int count{ generate_actions(state, actions) };
+	order(actions, count, ply, hinted ? &hint : nullptr);
+
+	bool maximizing{ state.m_turn == m_root };
+	Action best_action{ actions[0] };
+	int best{ maximizing ? -AI_INFINITY : AI_INFINITY };
+	for (int i{ 0 }; i < count; ++i)
+	{
+		GameState child{ state };
+		apply_action(child, actions[i]);
+		int score{ alpha_beta(child, depth - 1, ply + 1, alpha, beta) };
+		if (m_abort)
+			return 0;
+		if (maximizing ? score > best : score < best)
+		{
+			best = score;
+			best_action = actions[i];
+		}
+		if (maximizing)
+			alpha = std::max(alpha, score);
+		else
+			beta = std::min(beta, score);
+		if (alpha >= beta)
+		{
+			// remembered to be tried early in the sibling positions
+			if (actions[i].type != m_killer[ply][0].type || actions[i].value != m_killer[ply][0].value || actions[i].target != m_killer[ply][0].target)
+			{
+				m_killer[ply][1] = m_killer[ply][0];
+				m_killer[ply][0] = actions[i];
+			}
+			m_history[key(actions[i])] += depth * depth;
+			break;
+		}
+	}
+	// both kinds of nodes : a result outside of the window only bounds the score
+	BOUND bound{ (best <= window_alpha) ? BOUND::UPPER : ((best >= window_beta) ? BOUND::LOWER : BOUND::EXACT) };
+	m_table.store(state.m_hash, TTEntry{ to_table(best, ply), static_cast<std::uint8_t>(depth), table_bound(bound), true, best_action });
+	return best;
+}
+
+// the table holds scores for orange, wins counted from the position instead of from the root
+int AlphaBeta::to_table(int score, int ply) const
+{
+	if (score >= AI_WIN - 2 * AI_MAX_DEPTH)
+		score += ply;
+	else if (score <= -AI_WIN + 2 * AI_MAX_DEPTH)
+		score -= ply;
+	return (m_root == 0) ? score : -score;
+}
+
+int AlphaBeta::from_table(int score, int ply) const
+{
+	score = (m_root == 0) ? score : -score;
+	if (score >= AI_WIN - 2 * AI_MAX_DEPTH)
+		score -= ply;
+	else if (score <= -AI_WIN + 2 * AI_MAX_DEPTH)
+		score += ply;
+	return score;
+}
+
+BOUND AlphaBeta::table_bound(BOUND bound) const
+{
+	if (m_root == 0 || bound == BOUND::EXACT || bound == BOUND::NONE)
+		return bound;
+	return (bound == BOUND::LOWER) ? BOUND::UPPER : BOUND::LOWER;
+}
+
+// from the point of view of the root player : fruits, fruits on the edge of the remaining tiles and cards in hand
+int AlphaBeta::evaluate(const GameState& state) const
+{
+	const BitBoard& board{ state.m_board };
+	Bitboard alive{ board.m_alive };
+	Bitboard inner{ alive & shift(alive, DIRECTION::UP) & shift(alive, DIRECTION::DOWN) & shift(alive, DIRECTION::LEFT) & shift(alive, DIRECTION::RIGHT) };
+	int me{ m_root };
+	int score{ 100 * (popcount(board.free_fruits(me)) - popcount(board.free_fruits(1 - me))) };
+	score -= 20 * popcount(board.free_fruits(me) & ~inner);
+	score += 20 * popcount(board.free_fruits(1 - me) & ~inner);
+	score += 30 * (popcount(state.m_cards[me]) - popcount(state.m_cards[1 - me]));
+	return score;
+}
+
+int AlphaBeta::key(const Action& action) const
+{
+	if (action.type == ACTION::MOVE)
+		return action.value;
+	return 4 + action.value * (BOARD_CELLS + 1) + action.target;
+}
+
+// best first, then the killers of the ply, then by history
+void AlphaBeta::order(std::array<Action, MAX_ACTIONS>& actions, int count, int ply, const Action* best) const
+{
+	std::array<int, MAX_ACTIONS> score;
+	for (int i{ 0 }; i < count; ++i)
+	{
+		const Action& a{ actions[i] };
+		auto same = [&a](const Action& b) { return a.type == b.type && a.value == b.value && a.target == b.target; };
+		if (best && same(*best))
+			score[i] = AI_INFINITY;
+		else if (same(m_killer[ply][0]))
+			score[i] = AI_INFINITY - 1;
+		else if (same(m_killer[ply][1]))
+			score[i] = AI_INFINITY - 2;
+		else
+			score[i] = m_history[key(a)];
+	}
+	// insertion sort, stable so equal actions keep the moves first order of generate_actions
+	for (int i{ 1 }; i < count; ++i)
+	{
+		Action action{ actions[i] };
+		int value{ score[i] };
+		int j{ i };
+		for (; j > 0 && score[j - 1] < value; --j)
+		{
+			actions[j] = actions[j - 1];
+			score[j] = score[j - 1];
+		}
+		actions[j] = action;
+		score[j] = value;
+	}
+}
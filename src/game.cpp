@@ -2,10 +2,7 @@
 
 void Writer::write(char* c, std::bitset<10>& userInputs, float delta, int boundX, glm::vec3 cursor_shape)
 {
-	std::string character(c);
-	if (character.size() > 1) {
-		return;
-	}
+	std::string character(c); // UTF-8, one or more characters
 
 	WRITE_ACTION writeAction;
 	if (userInputs.test(6))
@@ -54,28 +51,26 @@ void Writer::write_aux(WRITE_ACTION writeAction, std::string& character, float d
 		if (boundX > (cursor_shape.x + cursor_shape.z))
 		{
 			m_textInput[m_cursor.m_focus].insert(m_cursor.m_pos, character.data(), character.size());
-			m_textSectionsWidth[m_cursor.m_focus].insert(m_textSectionsWidth[m_cursor.m_focus].begin() + m_cursor.m_pos, character.size());
-			m_cursor.m_pos++;
+			m_cursor.m_pos += static_cast<int>(character.size());
 		}
 	}
 	else if (writeAction == WRITE_ACTION::ERASE)
 	{
 		if (m_textInput[m_cursor.m_focus].size() > 0 && m_cursor.m_pos > 0)
 		{
-			int sectionWidth = m_textSectionsWidth[m_cursor.m_focus][m_cursor.m_pos - 1];
-			m_textSectionsWidth[m_cursor.m_focus].erase(m_textSectionsWidth[m_cursor.m_focus].begin() + m_cursor.m_pos - 1);
-			m_textInput[m_cursor.m_focus].erase(m_cursor.m_pos - sectionWidth, sectionWidth);
-			m_cursor.m_pos -= sectionWidth;
+			// every byte of the character before the cursor
+			int previous = static_cast<int>(utf8_previous(m_textInput[m_cursor.m_focus], m_cursor.m_pos));
+			m_textInput[m_cursor.m_focus].erase(previous, m_cursor.m_pos - previous);
+			m_cursor.m_pos = previous;
 		}
 	}
 	else if (writeAction == WRITE_ACTION::CURSOR_LEFT)
 	{
-		m_cursor.m_pos = max(0, m_cursor.m_pos - 1);
+		m_cursor.m_pos = static_cast<int>(utf8_previous(m_textInput[m_cursor.m_focus], m_cursor.m_pos));
 	}
 	else if (writeAction == WRITE_ACTION::CURSOR_RIGHT)
 	{
-		if (m_cursor.m_pos < m_textInput[m_cursor.m_focus].size())
-			m_cursor.m_pos = min(m_textInput[m_cursor.m_focus].size(), m_cursor.m_pos + 1);
+		m_cursor.m_pos = static_cast<int>(utf8_next(m_textInput[m_cursor.m_focus], m_cursor.m_pos));
 	}
 
 	m_lastWriteAction = writeAction;
@@ -90,10 +85,22 @@ Game::Game(int clientWidth, int clientHeight) :
 	m_turn(-1),
 	m_remaining_time(360),
 	m_winner(-1),
+	m_opponent_left(false),
 	m_writer(clientWidth, clientHeight),
-	m_move(MOVE::UNDEFINED),
-	m_animationTimer(0.0f)
+	m_ui(clientWidth, clientHeight),
+	m_network(nullptr),
+	m_snapshot_version(0),
+	m_typing(false),
+	m_state{},
+	m_predicted{},
+	m_pending{},
+	m_pending_count(0),
+	m_action_count(0),
+	m_selected_card(-1)
 {
+	m_snapshot.version = 0;
+	m_snapshot.new_game = false;
+
 	// create mouse
 	int mouse_pos[2];
 	SDL_GetMouseState(&mouse_pos[0], &mouse_pos[1]);
@@ -134,6 +141,11 @@ Game::Game(int clientWidth, int clientHeight) :
 
 void Game::createUI(int width, int height)
 {
+	// every image of the UI comes from the atlas, see texture_atlas.hpp
+	TextureAtlas& atlas{ m_ui.get_atlas() };
+	m_cards.load_images(atlas);
+	m_board.load_images(atlas);
+
 	// home page
 	m_ui.add_page();
 
@@ -155,189 +167,189 @@ void Game::createUI(int width, int height)
 	home_page.add_layer(14); // stop chercher adversaire
 	
 	Layer& h_layer0 = home_page.get_layer(0);
-	h_layer0.add_sprite(0, glm::vec2(0.0f), glm::vec2(width, height), width, height);
-	h_layer0.get_sprite(0)->set_background_img("assets/home.tga");
+	h_layer0.add_sprite(0, glm::vec2(0.0f), glm::vec2(width, height));
+	h_layer0.get_sprite(0)->set_background_img(atlas.get("assets/home.tga"));
 	h_layer0.get_sprite(0)->use_background_img();
 
 	Layer& h_layer1 = home_page.get_layer(1);
 	h_layer1.set_visibility(false);
-	h_layer1.add_sprite(1, glm::vec2(400, 728-(140+48)), glm::vec2(400, 48), width, height);
-	h_layer1.get_sprite(1)->set_background_img("assets/avatar/face_part_highlight.tga");
+	h_layer1.add_sprite(1, glm::vec2(400, 728-(140+48)), glm::vec2(400, 48));
+	h_layer1.get_sprite(1)->set_background_img(atlas.get("assets/avatar/face_part_highlight.tga"));
 	h_layer1.get_sprite(1)->use_background_img();
 
 	Layer& h_layer2 = home_page.get_layer(2);
-	h_layer2.add_sprite(2, glm::vec2(600, 728 - (140 + 48 - 12)), glm::vec2(150, 24), width, height);
-	h_layer2.get_sprite(2)->set_background_img("assets/avatar/visage.tga");
-	h_layer2.get_sprite(2)->set_background_img_selected("assets/avatar/visage_hover.tga");
+	h_layer2.add_sprite(2, glm::vec2(600, 728 - (140 + 48 - 12)), glm::vec2(150, 24));
+	h_layer2.get_sprite(2)->set_background_img(atlas.get("assets/avatar/visage.tga"));
+	h_layer2.get_sprite(2)->set_background_img_selected(atlas.get("assets/avatar/visage_hover.tga"));
 	h_layer2.get_sprite(2)->use_background_img();
 	h_layer2.get_sprite(2)->select();
 	// >>>>> highlight
 	h_layer1.get_sprite(1)->set_pos(glm::vec2(400, 728 - 140));
 	h_layer1.set_visibility(true);
 	// <<<<< highlight
-	h_layer2.add_sprite(3, glm::vec2(600, 728 - (140 + 48*2 - 12)), glm::vec2(150, 24), width, height);
-	h_layer2.get_sprite(3)->set_background_img("assets/avatar/cheveux.tga");
-	h_layer2.get_sprite(3)->set_background_img_selected("assets/avatar/cheveux_hover.tga");
+	h_layer2.add_sprite(3, glm::vec2(600, 728 - (140 + 48*2 - 12)), glm::vec2(150, 24));
+	h_layer2.get_sprite(3)->set_background_img(atlas.get("assets/avatar/cheveux.tga"));
+	h_layer2.get_sprite(3)->set_background_img_selected(atlas.get("assets/avatar/cheveux_hover.tga"));
 	h_layer2.get_sprite(3)->use_background_img();
-	h_layer2.add_sprite(4, glm::vec2(600, 728 - (140 + 48*3 - 12)), glm::vec2(150, 24), width, height);
-	h_layer2.get_sprite(4)->set_background_img("assets/avatar/yeux.tga");
-	h_layer2.get_sprite(4)->set_background_img_selected("assets/avatar/yeux_hover.tga");
+	h_layer2.add_sprite(4, glm::vec2(600, 728 - (140 + 48*3 - 12)), glm::vec2(150, 24));
+	h_layer2.get_sprite(4)->set_background_img(atlas.get("assets/avatar/yeux.tga"));
+	h_layer2.get_sprite(4)->set_background_img_selected(atlas.get("assets/avatar/yeux_hover.tga"));
 	h_layer2.get_sprite(4)->use_background_img();
-	h_layer2.add_sprite(5, glm::vec2(600, 728 - (140 + 48*4 - 12)), glm::vec2(150, 24), width, height);
-	h_layer2.get_sprite(5)->set_background_img("assets/avatar/bouche.tga");
-	h_layer2.get_sprite(5)->set_background_img_selected("assets/avatar/bouche_hover.tga");
+	h_layer2.add_sprite(5, glm::vec2(600, 728 - (140 + 48*4 - 12)), glm::vec2(150, 24));
+	h_layer2.get_sprite(5)->set_background_img(atlas.get("assets/avatar/bouche.tga"));
+	h_layer2.get_sprite(5)->set_background_img_selected(atlas.get("assets/avatar/bouche_hover.tga"));
 	h_layer2.get_sprite(5)->use_background_img();
-	h_layer2.add_sprite(6, glm::vec2(600, 728 - (140 + 48*5 - 12)), glm::vec2(150, 24), width, height);
-	h_layer2.get_sprite(6)->set_background_img("assets/avatar/sexe.tga");
-	h_layer2.get_sprite(6)->set_background_img_selected("assets/avatar/sexe_hover.tga");
+	h_layer2.add_sprite(6, glm::vec2(600, 728 - (140 + 48*5 - 12)), glm::vec2(150, 24));
+	h_layer2.get_sprite(6)->set_background_img(atlas.get("assets/avatar/sexe.tga"));
+	h_layer2.get_sprite(6)->set_background_img_selected(atlas.get("assets/avatar/sexe_hover.tga"));
 	h_layer2.get_sprite(6)->use_background_img();
 
 	Layer& h_layer3 = home_page.get_layer(3);
 	h_layer3.set_visibility(false);
-	h_layer3.add_sprite(7, glm::vec2(610, 728 - (140 + 48 + 12)), glm::vec2(130, 24), width, height);
-	h_layer3.get_sprite(7)->set_background_img("assets/avatar/visage_normal.tga");
-	h_layer3.get_sprite(7)->set_background_img_selected("assets/avatar/visage_normal_hover.tga");
+	h_layer3.add_sprite(7, glm::vec2(610, 728 - (140 + 48 + 12)), glm::vec2(130, 24));
+	h_layer3.get_sprite(7)->set_background_img(atlas.get("assets/avatar/visage_normal.tga"));
+	h_layer3.get_sprite(7)->set_background_img_selected(atlas.get("assets/avatar/visage_normal_hover.tga"));
 	h_layer3.get_sprite(7)->use_background_img();
 
 	Layer& h_layer4 = home_page.get_layer(4);
 	h_layer4.set_visibility(false);
-	h_layer4.add_sprite(8, glm::vec2(610, 728 - (140 + 48 * 2 + 12)), glm::vec2(130, 24), width, height);
-	h_layer4.get_sprite(8)->set_background_img("assets/avatar/cheveux_herisson.tga");
-	h_layer4.get_sprite(8)->set_background_img_selected("assets/avatar/cheveux_herisson_hover.tga");
+	h_layer4.add_sprite(8, glm::vec2(610, 728 - (140 + 48 * 2 + 12)), glm::vec2(130, 24));
+	h_layer4.get_sprite(8)->set_background_img(atlas.get("assets/avatar/cheveux_herisson.tga"));
+	h_layer4.get_sprite(8)->set_background_img_selected(atlas.get("assets/avatar/cheveux_herisson_hover.tga"));
 	h_layer4.get_sprite(8)->use_background_img();
-	h_layer4.add_sprite(9, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 24)), glm::vec2(130, 24), width, height);
-	h_layer4.get_sprite(9)->set_background_img("assets/avatar/cheveux_decoiffe.tga");
-	h_layer4.get_sprite(9)->set_background_img_selected("assets/avatar/cheveux_decoiffe_hover.tga");
+	h_layer4.add_sprite(9, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 24)), glm::vec2(130, 24));
+	h_layer4.get_sprite(9)->set_background_img(atlas.get("assets/avatar/cheveux_decoiffe.tga"));
+	h_layer4.get_sprite(9)->set_background_img_selected(atlas.get("assets/avatar/cheveux_decoiffe_hover.tga"));
 	h_layer4.get_sprite(9)->use_background_img();
-	h_layer4.add_sprite(10, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 48)), glm::vec2(130, 24), width, height);
-	h_layer4.get_sprite(10)->set_background_img("assets/avatar/cheveux_meche_avant.tga");
-	h_layer4.get_sprite(10)->set_background_img_selected("assets/avatar/cheveux_meche_avant_hover.tga");
+	h_layer4.add_sprite(10, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 48)), glm::vec2(130, 24));
+	h_layer4.get_sprite(10)->set_background_img(atlas.get("assets/avatar/cheveux_meche_avant.tga"));
+	h_layer4.get_sprite(10)->set_background_img_selected(atlas.get("assets/avatar/cheveux_meche_avant_hover.tga"));
 	h_layer4.get_sprite(10)->use_background_img();
-	h_layer4.add_sprite(11, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 72)), glm::vec2(130, 24), width, height);
-	h_layer4.get_sprite(11)->set_background_img("assets/avatar/cheveux_mixte.tga");
-	h_layer4.get_sprite(11)->set_background_img_selected("assets/avatar/cheveux_mixte_hover.tga");
+	h_layer4.add_sprite(11, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 72)), glm::vec2(130, 24));
+	h_layer4.get_sprite(11)->set_background_img(atlas.get("assets/avatar/cheveux_mixte.tga"));
+	h_layer4.get_sprite(11)->set_background_img_selected(atlas.get("assets/avatar/cheveux_mixte_hover.tga"));
 	h_layer4.get_sprite(11)->use_background_img();
-	h_layer4.add_sprite(12, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 96)), glm::vec2(130, 24), width, height);
-	h_layer4.get_sprite(12)->set_background_img("assets/avatar/cheveux_arriere.tga");
-	h_layer4.get_sprite(12)->set_background_img_selected("assets/avatar/cheveux_arriere_hover.tga");
+	h_layer4.add_sprite(12, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 96)), glm::vec2(130, 24));
+	h_layer4.get_sprite(12)->set_background_img(atlas.get("assets/avatar/cheveux_arriere.tga"));
+	h_layer4.get_sprite(12)->set_background_img_selected(atlas.get("assets/avatar/cheveux_arriere_hover.tga"));
 	h_layer4.get_sprite(12)->use_background_img();
 
 	Layer& h_layer5 = home_page.get_layer(5);
 	h_layer5.set_visibility(false);
-	h_layer5.add_sprite(13, glm::vec2(610, 728 - (140 + 48 * 2 + 12)), glm::vec2(130, 24), width, height);
-	h_layer5.get_sprite(13)->set_background_img("assets/avatar/cheveux_mixte.tga");
-	h_layer5.get_sprite(13)->set_background_img_selected("assets/avatar/cheveux_mixte_hover.tga");
+	h_layer5.add_sprite(13, glm::vec2(610, 728 - (140 + 48 * 2 + 12)), glm::vec2(130, 24));
+	h_layer5.get_sprite(13)->set_background_img(atlas.get("assets/avatar/cheveux_mixte.tga"));
+	h_layer5.get_sprite(13)->set_background_img_selected(atlas.get("assets/avatar/cheveux_mixte_hover.tga"));
 	h_layer5.get_sprite(13)->use_background_img();
-	h_layer5.add_sprite(14, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 24)), glm::vec2(130, 24), width, height);
-	h_layer5.get_sprite(14)->set_background_img("assets/avatar/cheveux_mi_long.tga");
-	h_layer5.get_sprite(14)->set_background_img_selected("assets/avatar/cheveux_mi_long_hover.tga");
+	h_layer5.add_sprite(14, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 24)), glm::vec2(130, 24));
+	h_layer5.get_sprite(14)->set_background_img(atlas.get("assets/avatar/cheveux_mi_long.tga"));
+	h_layer5.get_sprite(14)->set_background_img_selected(atlas.get("assets/avatar/cheveux_mi_long_hover.tga"));
 	h_layer5.get_sprite(14)->use_background_img();
-	h_layer5.add_sprite(15, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 48)), glm::vec2(130, 24), width, height);
-	h_layer5.get_sprite(15)->set_background_img("assets/avatar/cheveux_frange.tga");
-	h_layer5.get_sprite(15)->set_background_img_selected("assets/avatar/cheveux_frange_hover.tga");
+	h_layer5.add_sprite(15, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 48)), glm::vec2(130, 24));
+	h_layer5.get_sprite(15)->set_background_img(atlas.get("assets/avatar/cheveux_frange.tga"));
+	h_layer5.get_sprite(15)->set_background_img_selected(atlas.get("assets/avatar/cheveux_frange_hover.tga"));
 	h_layer5.get_sprite(15)->use_background_img();
-	h_layer5.add_sprite(16, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 72)), glm::vec2(130, 24), width, height);
-	h_layer5.get_sprite(16)->set_background_img("assets/avatar/cheveux_au_bol.tga");
-	h_layer5.get_sprite(16)->set_background_img_selected("assets/avatar/cheveux_au_bol_hover.tga");
+	h_layer5.add_sprite(16, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 72)), glm::vec2(130, 24));
+	h_layer5.get_sprite(16)->set_background_img(atlas.get("assets/avatar/cheveux_au_bol.tga"));
+	h_layer5.get_sprite(16)->set_background_img_selected(atlas.get("assets/avatar/cheveux_au_bol_hover.tga"));
 	h_layer5.get_sprite(16)->use_background_img();
-	h_layer5.add_sprite(17, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 96)), glm::vec2(130, 24), width, height);
-	h_layer5.get_sprite(17)->set_background_img("assets/avatar/queue_cheval.tga");
-	h_layer5.get_sprite(17)->set_background_img_selected("assets/avatar/queue_cheval_hover.tga");
+	h_layer5.add_sprite(17, glm::vec2(610, 728 - (140 + 48 * 2 + 12 + 96)), glm::vec2(130, 24));
+	h_layer5.get_sprite(17)->set_background_img(atlas.get("assets/avatar/queue_cheval.tga"));
+	h_layer5.get_sprite(17)->set_background_img_selected(atlas.get("assets/avatar/queue_cheval_hover.tga"));
 	h_layer5.get_sprite(17)->use_background_img();
 
 	Layer& h_layer6 = home_page.get_layer(6);
 	h_layer6.set_visibility(false);
-	h_layer6.add_sprite(18, glm::vec2(610, 728 - (140 + 48 * 3 + 12)), glm::vec2(130, 24), width, height);
-	h_layer6.get_sprite(18)->set_background_img("assets/avatar/yeux_manga.tga");
-	h_layer6.get_sprite(18)->set_background_img_selected("assets/avatar/yeux_manga_hover.tga");
+	h_layer6.add_sprite(18, glm::vec2(610, 728 - (140 + 48 * 3 + 12)), glm::vec2(130, 24));
+	h_layer6.get_sprite(18)->set_background_img(atlas.get("assets/avatar/yeux_manga.tga"));
+	h_layer6.get_sprite(18)->set_background_img_selected(atlas.get("assets/avatar/yeux_manga_hover.tga"));
 	h_layer6.get_sprite(18)->use_background_img();
-	h_layer6.add_sprite(19, glm::vec2(610, 728 - (140 + 48 * 3 + 12 + 24)), glm::vec2(130, 24), width, height);
-	h_layer6.get_sprite(19)->set_background_img("assets/avatar/yeux_amande.tga");
-	h_layer6.get_sprite(19)->set_background_img_selected("assets/avatar/yeux_amande_hover.tga");
+	h_layer6.add_sprite(19, glm::vec2(610, 728 - (140 + 48 * 3 + 12 + 24)), glm::vec2(130, 24));
+	h_layer6.get_sprite(19)->set_background_img(atlas.get("assets/avatar/yeux_amande.tga"));
+	h_layer6.get_sprite(19)->set_background_img_selected(atlas.get("assets/avatar/yeux_amande_hover.tga"));
 	h_layer6.get_sprite(19)->use_background_img();
-	h_layer6.add_sprite(20, glm::vec2(610, 728 - (140 + 48 * 3 + 12 + 48)), glm::vec2(130, 24), width, height);
-	h_layer6.get_sprite(20)->set_background_img("assets/avatar/yeux_gros.tga");
-	h_layer6.get_sprite(20)->set_background_img_selected("assets/avatar/yeux_gros_hover.tga");
+	h_layer6.add_sprite(20, glm::vec2(610, 728 - (140 + 48 * 3 + 12 + 48)), glm::vec2(130, 24));
+	h_layer6.get_sprite(20)->set_background_img(atlas.get("assets/avatar/yeux_gros.tga"));
+	h_layer6.get_sprite(20)->set_background_img_selected(atlas.get("assets/avatar/yeux_gros_hover.tga"));
 	h_layer6.get_sprite(20)->use_background_img();
 
 	Layer& h_layer7 = home_page.get_layer(7);
 	h_layer7.set_visibility(false);
-	h_layer7.add_sprite(21, glm::vec2(610, 728 - (140 + 48 * 3 + 12)), glm::vec2(130, 24), width, height);
-	h_layer7.get_sprite(21)->set_background_img("assets/avatar/yeux_egypte.tga");
-	h_layer7.get_sprite(21)->set_background_img_selected("assets/avatar/yeux_egypte_hover.tga");
+	h_layer7.add_sprite(21, glm::vec2(610, 728 - (140 + 48 * 3 + 12)), glm::vec2(130, 24));
+	h_layer7.get_sprite(21)->set_background_img(atlas.get("assets/avatar/yeux_egypte.tga"));
+	h_layer7.get_sprite(21)->set_background_img_selected(atlas.get("assets/avatar/yeux_egypte_hover.tga"));
 	h_layer7.get_sprite(21)->use_background_img();
-	h_layer7.add_sprite(22, glm::vec2(610, 728 - (140 + 48 * 3 + 12 + 24)), glm::vec2(130, 24), width, height);
-	h_layer7.get_sprite(22)->set_background_img("assets/avatar/yeux_mascara.tga");
-	h_layer7.get_sprite(22)->set_background_img_selected("assets/avatar/yeux_mascara_hover.tga");
+	h_layer7.add_sprite(22, glm::vec2(610, 728 - (140 + 48 * 3 + 12 + 24)), glm::vec2(130, 24));
+	h_layer7.get_sprite(22)->set_background_img(atlas.get("assets/avatar/yeux_mascara.tga"));
+	h_layer7.get_sprite(22)->set_background_img_selected(atlas.get("assets/avatar/yeux_mascara_hover.tga"));
 	h_layer7.get_sprite(22)->use_background_img();
 
 	Layer& h_layer8 = home_page.get_layer(8);
 	h_layer8.set_visibility(false);
-	h_layer8.add_sprite(23, glm::vec2(610, 728 - (140 + 48 * 4 + 12)), glm::vec2(130, 24), width, height);
-	h_layer8.get_sprite(23)->set_background_img("assets/avatar/bouche_petite.tga");
-	h_layer8.get_sprite(23)->set_background_img_selected("assets/avatar/bouche_petite_hover.tga");
+	h_layer8.add_sprite(23, glm::vec2(610, 728 - (140 + 48 * 4 + 12)), glm::vec2(130, 24));
+	h_layer8.get_sprite(23)->set_background_img(atlas.get("assets/avatar/bouche_petite.tga"));
+	h_layer8.get_sprite(23)->set_background_img_selected(atlas.get("assets/avatar/bouche_petite_hover.tga"));
 	h_layer8.get_sprite(23)->use_background_img();
-	h_layer8.add_sprite(24, glm::vec2(610, 728 - (140 + 48 * 4 + 12 + 24)), glm::vec2(130, 24), width, height);
-	h_layer8.get_sprite(24)->set_background_img("assets/avatar/bouche_moyenne.tga");
-	h_layer8.get_sprite(24)->set_background_img_selected("assets/avatar/bouche_moyenne_hover.tga");
+	h_layer8.add_sprite(24, glm::vec2(610, 728 - (140 + 48 * 4 + 12 + 24)), glm::vec2(130, 24));
+	h_layer8.get_sprite(24)->set_background_img(atlas.get("assets/avatar/bouche_moyenne.tga"));
+	h_layer8.get_sprite(24)->set_background_img_selected(atlas.get("assets/avatar/bouche_moyenne_hover.tga"));
 	h_layer8.get_sprite(24)->use_background_img();
-	h_layer8.add_sprite(25, glm::vec2(610, 728 - (140 + 48 * 4 + 12 + 48)), glm::vec2(130, 24), width, height);
-	h_layer8.get_sprite(25)->set_background_img("assets/avatar/bouche_grande.tga");
-	h_layer8.get_sprite(25)->set_background_img_selected("assets/avatar/bouche_grande_hover.tga");
+	h_layer8.add_sprite(25, glm::vec2(610, 728 - (140 + 48 * 4 + 12 + 48)), glm::vec2(130, 24));
+	h_layer8.get_sprite(25)->set_background_img(atlas.get("assets/avatar/bouche_grande.tga"));
+	h_layer8.get_sprite(25)->set_background_img_selected(atlas.get("assets/avatar/bouche_grande_hover.tga"));
 	h_layer8.get_sprite(25)->use_background_img();
 
 	Layer& h_layer9 = home_page.get_layer(9);
 	h_layer9.set_visibility(false);
-	h_layer9.add_sprite(26, glm::vec2(610, 728 - (140 + 48 * 5 + 12)), glm::vec2(130, 24), width, height);
-	h_layer9.get_sprite(26)->set_background_img("assets/avatar/sexe_homme.tga");
-	h_layer9.get_sprite(26)->set_background_img_selected("assets/avatar/sexe_homme_hover.tga");
+	h_layer9.add_sprite(26, glm::vec2(610, 728 - (140 + 48 * 5 + 12)), glm::vec2(130, 24));
+	h_layer9.get_sprite(26)->set_background_img(atlas.get("assets/avatar/sexe_homme.tga"));
+	h_layer9.get_sprite(26)->set_background_img_selected(atlas.get("assets/avatar/sexe_homme_hover.tga"));
 	h_layer9.get_sprite(26)->use_background_img();
 	h_layer9.get_sprite(26)->select();
-	h_layer9.add_sprite(27, glm::vec2(610, 728 - (140 + 48 * 5 + 12 + 24)), glm::vec2(130, 24), width, height);
-	h_layer9.get_sprite(27)->set_background_img("assets/avatar/sexe_femme.tga");
-	h_layer9.get_sprite(27)->set_background_img_selected("assets/avatar/sexe_femme_hover.tga");
+	h_layer9.add_sprite(27, glm::vec2(610, 728 - (140 + 48 * 5 + 12 + 24)), glm::vec2(130, 24));
+	h_layer9.get_sprite(27)->set_background_img(atlas.get("assets/avatar/sexe_femme.tga"));
+	h_layer9.get_sprite(27)->set_background_img_selected(atlas.get("assets/avatar/sexe_femme_hover.tga"));
 	h_layer9.get_sprite(27)->use_background_img();
 
 	Layer& h_layer10 = home_page.get_layer(10);
-	h_layer10.add_sprite(28, glm::vec2(250, 728 - (140 + 48 * 5 + 12 + 24)), glm::vec2(300, 300), width, height);
+	h_layer10.add_sprite(28, glm::vec2(250, 728 - (140 + 48 * 5 + 12 + 24)), glm::vec2(300, 300));
 	h_layer10.get_sprite(28)->set_background_img_gl(graphics.avatarFBO->getAttachments()[0].id);
 	h_layer10.get_sprite(28)->use_background_img_gl();
 
 	Layer& h_layer11 = home_page.get_layer(11);
-	h_layer11.add_sprite(29, glm::vec2(225, 728 - 285), glm::vec2(50, 50), width, height);
-	h_layer11.get_sprite(29)->set_background_img("assets/avatar/couleur_left.tga");
+	h_layer11.add_sprite(29, glm::vec2(225, 728 - 285), glm::vec2(50, 50));
+	h_layer11.get_sprite(29)->set_background_img(atlas.get("assets/avatar/couleur_left.tga"));
 	h_layer11.get_sprite(29)->use_background_img();
-	h_layer11.add_sprite(30, glm::vec2(525, 728 - 285), glm::vec2(50, 50), width, height);
-	h_layer11.get_sprite(30)->set_background_img("assets/avatar/couleur_right.tga");
+	h_layer11.add_sprite(30, glm::vec2(525, 728 - 285), glm::vec2(50, 50));
+	h_layer11.get_sprite(30)->set_background_img(atlas.get("assets/avatar/couleur_right.tga"));
 	h_layer11.get_sprite(30)->use_background_img();
-	h_layer11.add_sprite(31, glm::vec2(1050 - 60, 728 - 65), glm::vec2(50, 50), width, height);
-	h_layer11.get_sprite(31)->set_background_img("assets/off.tga");
+	h_layer11.add_sprite(31, glm::vec2(1050 - 60, 728 - 65), glm::vec2(50, 50));
+	h_layer11.get_sprite(31)->set_background_img(atlas.get("assets/off.tga"));
 	h_layer11.get_sprite(31)->use_background_img();
-	h_layer11.add_sprite(32, glm::vec2(902, 728 - 72), glm::vec2(60, 60), width, height);
-	h_layer11.get_sprite(32)->set_background_img("assets/internet_off.tga");
+	h_layer11.add_sprite(32, glm::vec2(902, 728 - 72), glm::vec2(60, 60));
+	h_layer11.get_sprite(32)->set_background_img(atlas.get("assets/internet_off.tga"));
 	h_layer11.get_sprite(32)->set_bloom_strength(100.0f);
 	h_layer11.get_sprite(32)->use_background_img();
 
 	Layer& h_layer12 = home_page.get_layer(12);
-	h_layer12.add_sprite(33, glm::vec2(525 - 75, 728 - (140 + 48 * 7 - 12)), glm::vec2(150, 30), width, height);
-	h_layer12.get_sprite(33)->set_background_img("assets/pseudo.tga");
-	h_layer12.get_sprite(33)->set_background_img_selected("assets/pseudo_hover.tga");
+	h_layer12.add_sprite(33, glm::vec2(525 - 75, 728 - (140 + 48 * 7 - 12)), glm::vec2(150, 30));
+	h_layer12.get_sprite(33)->set_background_img(atlas.get("assets/pseudo.tga"));
+	h_layer12.get_sprite(33)->set_background_img_selected(atlas.get("assets/pseudo_hover.tga"));
 	h_layer12.get_sprite(33)->use_background_img();
-	h_layer12.add_sprite(34, glm::vec2(525 - 75, 728 - (140 + 48 * 8 - 24)), glm::vec2(150, 24), width, height);
-	h_layer12.get_sprite(34)->set_background_img("assets/connexion.tga");
-	h_layer12.get_sprite(34)->set_background_img_selected("assets/connexion_hover.tga");
+	h_layer12.add_sprite(34, glm::vec2(525 - 75, 728 - (140 + 48 * 8 - 24)), glm::vec2(150, 24));
+	h_layer12.get_sprite(34)->set_background_img(atlas.get("assets/connexion.tga"));
+	h_layer12.get_sprite(34)->set_background_img_selected(atlas.get("assets/connexion_hover.tga"));
 	h_layer12.get_sprite(34)->use_background_img();
 
 	Layer& h_layer13 = home_page.get_layer(13);
-	h_layer13.add_sprite(35, glm::vec2(525 - 75, 246), glm::vec2(150, 24), width, height);
-	h_layer13.get_sprite(35)->set_background_img("assets/jouer.tga");
-	h_layer13.get_sprite(35)->set_background_img_selected("assets/jouer_hover.tga");
+	h_layer13.add_sprite(35, glm::vec2(525 - 75, 246), glm::vec2(150, 24));
+	h_layer13.get_sprite(35)->set_background_img(atlas.get("assets/jouer.tga"));
+	h_layer13.get_sprite(35)->set_background_img_selected(atlas.get("assets/jouer_hover.tga"));
 	h_layer13.get_sprite(35)->use_background_img();
 
 	Layer& h_layer14 = home_page.get_layer(14);
-	h_layer14.add_sprite(36, glm::vec2(525 - 40, 240), glm::vec2(80, 24), width, height);
-	h_layer14.get_sprite(36)->set_background_img("assets/stop_search.tga");
-	h_layer14.get_sprite(36)->set_background_img_selected("assets/stop_search_hover.tga");
+	h_layer14.add_sprite(36, glm::vec2(525 - 40, 240), glm::vec2(80, 24));
+	h_layer14.get_sprite(36)->set_background_img(atlas.get("assets/stop_search.tga"));
+	h_layer14.get_sprite(36)->set_background_img_selected(atlas.get("assets/stop_search_hover.tga"));
 	h_layer14.get_sprite(36)->use_background_img();
 
 	// game page
@@ -352,47 +364,47 @@ void Game::createUI(int width, int height)
 	game_page.add_layer(5);	// message pop up (disconnected, win game, lost game, enemy abandonned)
 
 	Layer& g_layer0 = game_page.get_layer(0);
-	g_layer0.add_sprite(0, glm::vec2(0), glm::vec2(width, height), width, height);
-	g_layer0.get_sprite(0)->set_background_img("assets/game.tga");
+	g_layer0.add_sprite(0, glm::vec2(0), glm::vec2(width, height));
+	g_layer0.get_sprite(0)->set_background_img(atlas.get("assets/game.tga"));
 	g_layer0.get_sprite(0)->use_background_img();
-	g_layer0.add_sprite(1, glm::vec2(21, 728-23-130), glm::vec2(130, 130), width, height);
+	g_layer0.add_sprite(1, glm::vec2(21, 728-23-130), glm::vec2(130, 130));
 	g_layer0.get_sprite(1)->set_background_img_gl(graphics.avatarFBO->getAttachments()[0].id);
 	g_layer0.get_sprite(1)->use_background_img_gl();
-	g_layer0.add_sprite(2, glm::vec2(896, 728-23-130), glm::vec2(130, 130), width, height);
+	g_layer0.add_sprite(2, glm::vec2(896, 728-23-130), glm::vec2(130, 130));
 	g_layer0.get_sprite(2)->set_background_img_gl(graphics.opponentAvatarFBO->getAttachments()[0].id);
 	g_layer0.get_sprite(2)->use_background_img_gl();
 
 	Layer& g_layer1 = game_page.get_layer(1);
-	g_layer1.add_sprite(3, glm::vec2(473, 728+17-105), glm::vec2(105), width, height);
-	g_layer1.get_sprite(3)->set_background_img("assets/arrow_up.tga");
-	g_layer1.get_sprite(3)->set_background_img_selected("assets/arrow_up_hover.tga");
+	g_layer1.add_sprite(3, glm::vec2(473, 728+17-105), glm::vec2(105));
+	g_layer1.get_sprite(3)->set_background_img(atlas.get("assets/arrow_up.tga"));
+	g_layer1.get_sprite(3)->set_background_img_selected(atlas.get("assets/arrow_up_hover.tga"));
 	g_layer1.get_sprite(3)->use_background_img();
-	g_layer1.add_sprite(4, glm::vec2(473, 728-465-105), glm::vec2(105), width, height);
-	g_layer1.get_sprite(4)->set_background_img("assets/arrow_down.tga");
-	g_layer1.get_sprite(4)->set_background_img_selected("assets/arrow_down_hover.tga");
+	g_layer1.add_sprite(4, glm::vec2(473, 728-465-105), glm::vec2(105));
+	g_layer1.get_sprite(4)->set_background_img(atlas.get("assets/arrow_down.tga"));
+	g_layer1.get_sprite(4)->set_background_img_selected(atlas.get("assets/arrow_down_hover.tga"));
 	g_layer1.get_sprite(4)->use_background_img();
-	g_layer1.add_sprite(5, glm::vec2(719, 728-225-105), glm::vec2(105), width, height);
-	g_layer1.get_sprite(5)->set_background_img("assets/arrow_right.tga");
-	g_layer1.get_sprite(5)->set_background_img_selected("assets/arrow_right_hover.tga");
+	g_layer1.add_sprite(5, glm::vec2(719, 728-225-105), glm::vec2(105));
+	g_layer1.get_sprite(5)->set_background_img(atlas.get("assets/arrow_right.tga"));
+	g_layer1.get_sprite(5)->set_background_img_selected(atlas.get("assets/arrow_right_hover.tga"));
 	g_layer1.get_sprite(5)->use_background_img();
-	g_layer1.add_sprite(6, glm::vec2(229, 728-225-105), glm::vec2(105), width, height);
-	g_layer1.get_sprite(6)->set_background_img("assets/arrow_left.tga");
-	g_layer1.get_sprite(6)->set_background_img_selected("assets/arrow_left_hover.tga");
+	g_layer1.add_sprite(6, glm::vec2(229, 728-225-105), glm::vec2(105));
+	g_layer1.get_sprite(6)->set_background_img(atlas.get("assets/arrow_left.tga"));
+	g_layer1.get_sprite(6)->set_background_img_selected(atlas.get("assets/arrow_left_hover.tga"));
 	g_layer1.get_sprite(6)->use_background_img();
-	g_layer1.add_sprite(7, glm::vec2(1050-120, 0), glm::vec2(120, 30), width, height);
-	g_layer1.get_sprite(7)->set_background_img("assets/abandonner.tga");
-	g_layer1.get_sprite(7)->set_background_img_selected("assets/abandonner_hover.tga");
+	g_layer1.add_sprite(7, glm::vec2(1050-120, 0), glm::vec2(120, 30));
+	g_layer1.get_sprite(7)->set_background_img(atlas.get("assets/abandonner.tga"));
+	g_layer1.get_sprite(7)->set_background_img_selected(atlas.get("assets/abandonner_hover.tga"));
 	g_layer1.get_sprite(7)->use_background_img();
 
 	Layer& g_layer2 = game_page.get_layer(2);
-	g_layer2.add_sprite(8, glm::vec2(240, 728 - 698 - 20), glm::vec2(572, 25), width, height);
-	g_layer2.get_sprite(8)->set_background_img("assets/chat_input.tga");
-	g_layer2.get_sprite(8)->set_background_img_selected("assets/chat_input_hover.tga");
+	g_layer2.add_sprite(8, glm::vec2(240, 728 - 698 - 20), glm::vec2(572, 25));
+	g_layer2.get_sprite(8)->set_background_img(atlas.get("assets/chat_input.tga"));
+	g_layer2.get_sprite(8)->set_background_img_selected(atlas.get("assets/chat_input_hover.tga"));
 	g_layer2.get_sprite(8)->use_background_img();
 
 	Layer& g_layer3 = game_page.get_layer(3);
 	g_layer3.set_visibility(false);
-	g_layer3.add_sprite(9, glm::vec2(238, 728 - 559 - 164), glm::vec2(577, 164), width, height);
+	g_layer3.add_sprite(9, glm::vec2(238, 728 - 559 - 164), glm::vec2(577, 164));
 	g_layer3.get_sprite(9)->set_background_img_gl(-1);
 	g_layer3.get_sprite(9)->use_background_img_gl();
 
@@ -465,10 +477,7 @@ void Game::draw(float& delta, double& elapsedTime, int width, int height, DRAWIN
 			motionBlurPass(activeScene, width, height);
 		*/
 		// SET ACTIVE PAGE
-		g_game_init_mutex.lock();
 		bool game_found{ g_game_found };
-		std::string game_init{ g_game_init };
-		g_game_init_mutex.unlock();
 
 		if (!game_found)
 		{
@@ -478,7 +487,12 @@ void Game::draw(float& delta, double& elapsedTime, int width, int height, DRAWIN
 		{
 			m_ui.set_active_page(1);
 
-			if (!game_init.empty())
+			if (m_snapshot.version != m_snapshot_version && !m_snapshot.new_game) // resynchronization of the current game
+			{
+				apply_snapshot(m_snapshot);
+				m_snapshot_version = m_snapshot.version;
+			}
+			else if (m_snapshot.version != m_snapshot_version) // a new game started since the last frame
 			{
 				// reset search opponent
 				g_search_opponent = false;
@@ -489,183 +503,17 @@ void Game::draw(float& delta, double& elapsedTime, int width, int height, DRAWIN
 				// use police of size 15
 				textRenderer->use_police(1);
 
-				// process message
-				std::istringstream msg(game_init);
-				std::vector<std::string> data;
-				std::string section;
-				while (getline(msg, section, ':'))
-				{
-					data.push_back(section);
-				}
-				// my fruit
-				m_fruit = std::atoi(data[0].c_str());
-				// turn
-				m_turn = std::atoi(data[1].c_str());
-				// set opponent name and avatar
-				std::string opponent_name = data[2];
-				if (m_fruit == 0) {
-					m_pseudo_orange = m_writer.m_textInput[0];
-					m_pseudo_banane = opponent_name;
-				}
-				else {
-					m_pseudo_banane = m_writer.m_textInput[0];
-					m_pseudo_orange = opponent_name;
-				}
+				// nothing predicted from the previous game
+				m_opponent_left = false;
+				m_pending_count = 0;
+				m_action_count = m_snapshot.ack;
+				m_selected_card = -1;
+				m_board.stop_animation();
 
-				std::string opponent_avatar = data[3];
-				std::istringstream pp(opponent_avatar);
-				std::vector<std::string> pp_attr;
-				std::string attr;
-				while (getline(pp, attr, '.'))
-				{
-					pp_attr.push_back(attr);
-				}
-				m_avatar_opponent.m_skin_color_id = std::atoi(pp_attr[4].c_str());
-				m_avatar_opponent.m_hair_color_id = std::atoi(pp_attr[5].c_str());
-				m_avatar_opponent.m_eyes_color_id = std::atoi(pp_attr[6].c_str());
-				int hair = std::atoi(pp_attr[1].c_str());
-				int eyes = std::atoi(pp_attr[2].c_str());
-				// gender
-				int gender = std::atoi(pp_attr[0].c_str());
-				if (gender == 0)
-				{
-					m_avatar_opponent.m_gender = Avatar::GENDER::MALE;
-					// hair
-					switch (hair)
-					{
-					case 0:
-						m_avatar_opponent.m_hair = Avatar::HAIR::MIXTE;
-						break;
-					case 1:
-						m_avatar_opponent.m_hair = Avatar::HAIR::HERISSON;
-						break;
-					case 2:
-						m_avatar_opponent.m_hair = Avatar::HAIR::DECOIFFE;
-						break;
-					case 3:
-						m_avatar_opponent.m_hair = Avatar::HAIR::ARRIERE;
-						break;
-					case 4:
-						m_avatar_opponent.m_hair = Avatar::HAIR::MECHE_AVANT;
-						break;
-					default:
-						break;
-					};
-					// eyes
-					switch (eyes)
-					{
-					case 0:
-						m_avatar_opponent.m_eyes = Avatar::EYES::MANGA;
-						break;
-					case 1:
-						m_avatar_opponent.m_eyes = Avatar::EYES::AMANDE;
-						break;
-					case 2:
-						m_avatar_opponent.m_eyes = Avatar::EYES::GROS;
-						break;
-					default:
-						break;
-					};
-				}
-				else if (gender == 1)
-				{
-					m_avatar_opponent.m_gender = Avatar::GENDER::FEMALE;
-					// hair
-					switch (hair)
-					{
-					case 0:
-						m_avatar_opponent.m_hair = Avatar::HAIR::MIXTE;
-						break;
-					case 5:
-						m_avatar_opponent.m_hair = Avatar::HAIR::MI_LONG;
-						break;
-					case 6:
-						m_avatar_opponent.m_hair = Avatar::HAIR::FRANGE;
-						break;
-					case 7:
-						m_avatar_opponent.m_hair = Avatar::HAIR::AU_BOL;
-						break;
-					case 8:
-						m_avatar_opponent.m_hair = Avatar::HAIR::PONYTAIL;
-						break;
-					default:
-						break;
-					};
-					// eyes
-					switch (eyes)
-					{
-					case 0:
-						m_avatar_opponent.m_eyes = Avatar::EYES::MANGA;
-						break;
-					case 3:
-						m_avatar_opponent.m_eyes = Avatar::EYES::EGYPTE;
-						break;
-					case 4:
-						m_avatar_opponent.m_eyes = Avatar::EYES::MASCARA;
-						break;
-					default:
-						break;
-					};
-				}
-				// mouth
-				int mouth = std::atoi(pp_attr[3].c_str());
-				if (mouth == 0) {
-					m_avatar_opponent.m_mouth = Avatar::MOUTH::PETITE;
-				}
-				else if (mouth == 1) {
-					m_avatar_opponent.m_mouth = Avatar::MOUTH::MOYENNE;
-				}
-				else if (mouth == 2) {
-					m_avatar_opponent.m_mouth = Avatar::MOUTH::GRANDE;
-				}
-
-				// cards
-				std::string my_cards = data[4];
-				std::istringstream cards_stream(my_cards);
-				std::vector<int> card_id;
-				std::string id;
-				while (getline(cards_stream, id, '.'))
-				{
-					card_id.push_back(std::atoi(id.c_str()));
-				}
-				if (m_fruit == 0) { // orange
-					m_cards.m_slot[0] = card_id[0];
-					m_cards.m_slot[1] = card_id[1];
-					m_cards.m_slot[2] = card_id[2];
-
-					m_cards.m_slot[8] = 12;
-					m_cards.m_slot[9] = 12;
-					m_cards.m_slot[10] = 12;
-				}
-				else {				// banane
-					m_cards.m_slot[0] = 12;
-					m_cards.m_slot[1] = 12;
-					m_cards.m_slot[2] = 12;
-
-					m_cards.m_slot[8] = card_id[0];
-					m_cards.m_slot[9] = card_id[1];
-					m_cards.m_slot[10] = card_id[2];
-				}
-				
-				// board
-				std::string board = data[5];
-				std::istringstream fruits_stream(board);
-				std::vector<std::string> fruits;
-				std::string fruit;
-				while (getline(fruits_stream, fruit, '.'))
-				{
-					fruits.push_back(fruit);
-				}
-				for (int i{ 0 }; i < 8; ++i)
-				{
-					for (int j{ 0 }; j < 8; ++j)
-					{
-						m_board.m_fruit[j][i].m_type = std::atoi(fruits[j*8+i].c_str());
-					}
-				}
+				// publish the snapshot to the board, the cards and the opponent avatar
+				apply_snapshot(m_snapshot);
 
-				// reset init data
-				g_game_init.clear();
+				m_snapshot_version = m_snapshot.version;
 
 				// play sound
 				scenes[activeScene].playSound(0, 0);
@@ -713,13 +561,19 @@ void Game::drawUI(float& delta, double& elapsedTime, int width, int height, DRAW
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT);
 
-	m_ui.get_page(m_ui.get_active_page()).draw();
+	// sprites of the page, cards and board in one batch, drawn before the text
+	SpriteBatch& batch{ m_ui.get_batch() };
+	m_ui.draw();
+	if (m_ui.get_active_page() == 1) {
+		m_cards.draw(batch);
+		m_board.draw_tiles(batch);
+		m_board.draw_fruits(batch, delta);
+	}
+	batch.flush();
 
 	// draw text and game data
 	if (m_ui.get_active_page() == 0) {
-		g_connected_mutex.lock();
 		bool connected2server{ g_connected };
-		g_connected_mutex.unlock();
 		if (!connected2server && !g_try_connection && !g_search_opponent)
 		{
 			textRenderer->print(m_writer.m_textInput[0], 525 - 72, 272, 1, glm::vec3(0));
@@ -746,11 +600,6 @@ void Game::drawUI(float& delta, double& elapsedTime, int width, int height, DRAW
 		//print remaining fruits
 		textRenderer->print(std::to_string(m_board.orange_count()), 190, 728 - 52, 1, glm::vec3(0));
 		textRenderer->print(std::to_string(m_board.banane_count()), 863, 728 - 52, 1, glm::vec3(0));
-		// draw cards
-		m_cards.draw();
-		// draw board
-		m_board.draw_tiles();
-		m_board.draw_fruits();
 		if (!m_ui.get_page(1).get_layer(3).m_visible)
 		{
 			// draw chat input
@@ -761,10 +610,17 @@ void Game::drawUI(float& delta, double& elapsedTime, int width, int height, DRAW
 				glm::vec3 cursor_shape = textRenderer->get_cursor_shape(m_writer.m_textInput[1], 240 + 13, 728 - 698 - 12, 1, m_writer.m_cursor.m_pos);
 				m_writer.m_cursor.draw(cursor_shape, delta);
 			}
-			// draw conversation
-			for (int i{ 1 }; i <= m_writer.m_chatLog.size(); ++i)
+			// draw conversation, only the most recent lines fit
+			const ChatLog& chat_log{ m_writer.m_chatLog };
+			std::size_t first{ chat_log.first_visible(CHAT_VISIBLE_LINES) };
+			for (std::size_t i{ first }; i < chat_log.size(); ++i)
 			{
-				textRenderer->print(m_writer.m_chatLog[i - 1], 240 + 13, 728 - 568 - 16 * i, 1, glm::vec3(0));
+				int row{ static_cast<int>(i - first) + 1 };
+				textRenderer->print(chat_log.line(i), 240 + 13, 728 - 568 - 16 * row, 1, glm::vec3(0));
+			}
+			if (g_opponent_typing)
+			{
+				textRenderer->print("...", 240 + 13, 728 - 568 - 16 * (CHAT_VISIBLE_LINES + 1), 1, glm::vec3(0.5f));
 			}
 		}
 	}
@@ -975,8 +831,18 @@ Writer& Game::get_writer()
 	return m_writer;
 }
 
+RenderStats Game::get_render_stats()
+{
+	SpriteBatch& batch{ m_ui.get_batch() };
+	RenderStats render{ batch.get_draw_calls(), m_ui.get_atlas().get_page_count(), textRenderer->get_page_count() };
+	batch.reset_stats();
+	return render;
+}
+
 void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int screenH, float delta)
 {
+	poll_messages();
+
 	int* mouse_pos = m_mouse->get_position();
 	int* mouse_size = m_mouse->get_size();
 	m_mouse->use_normal();
@@ -988,46 +854,23 @@ void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int
 	if (m_ui.get_active_page() == 0) // home
 	{
 		Page& home_page{m_ui.get_page(0)};
+		TextureAtlas& atlas{ m_ui.get_atlas() };
 		int sprite_id{ hovered->get_id() };
 
 		// display connection status
-		bool connected2server;
-		g_connected_mutex.lock();
-		connected2server = g_connected;
-		g_connected_mutex.unlock();
+		bool connected2server{ g_connected };
 		if (connected2server) {
 			g_try_connection = false;
-			home_page.get_layer(11).get_sprite(32)->set_background_img("assets/internet_on.tga");
+			home_page.get_layer(11).get_sprite(32)->set_background_img(atlas.get("assets/internet_on.tga"));
 		}
 		else {
-			home_page.get_layer(11).get_sprite(32)->set_background_img("assets/internet_off.tga");
+			home_page.get_layer(11).get_sprite(32)->set_background_img(atlas.get("assets/internet_off.tga"));
 		}
 		if (g_try_connection)
 		{
-			// check connection result
-			std::string message;
-			g_msg2client_mutex.lock();
-			if (!g_msg2client_queue.empty())
-			{
-				message = g_msg2client_queue.front();
-				g_msg2client_queue.pop();
-				g_msg2client_mutex.unlock();
-				int code = std::atoi(message.substr(0, message.find_first_of(':')).c_str());
-				if (code == 0)
-				{
-					int result = std::atoi(message.substr(message.find_first_of(':') + 1).c_str());
-					if (result == 0) // connection failed
-					{
-						g_try_connection = false;
-					}
-				}
-			}
-			else
-			{
-				g_msg2client_mutex.unlock();
-				home_page.get_layer(12).set_visibility(false);
-				home_page.get_layer(13).set_visibility(false);
-			}
+			// waiting for the connection result, see poll_messages()
+			home_page.get_layer(12).set_visibility(false);
+			home_page.get_layer(13).set_visibility(false);
 		}
 		else
 		{
@@ -1462,113 +1305,23 @@ void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int
 		{
 			home_page.get_layer(12).get_sprite(sprite_id)->use_background_img_selected();
 			m_writer.m_cursor.m_focus = 0; // 0 = pseudo, 1 = chat, 2 = not writting
+			m_writer.m_cursor.m_pos = textRenderer->get_cursor_pos(m_writer.m_textInput[0], 525 - 72, 1, mouse_pos[0]);
 		}
 		else if (sprite_id == 34 && inputs.test(2) && inputs.test(9)) // clicked on connect
 		{
 			g_try_connection = true;
-			std::string data("0:" + m_writer.m_textInput[0] + ":");
-			// gender
-			if (m_avatar.m_gender == Avatar::GENDER::MALE) {
-				data += "0.";
-				// hair
-				switch (m_avatar.m_hair)
-				{
-				case Avatar::HAIR::MIXTE:
-					data += "0.";
-					break;
-				case Avatar::HAIR::HERISSON:
-					data += "1.";
-					break;
-				case Avatar::HAIR::DECOIFFE:
-					data += "2.";
-					break;
-				case Avatar::HAIR::ARRIERE:
-					data += "3.";
-					break;
-				case Avatar::HAIR::MECHE_AVANT:
-					data += "4.";
-					break;
-				default:
-					break;
-				};
-				// eyes
-				switch (m_avatar.m_eyes)
-				{
-				case Avatar::EYES::MANGA:
-					data += "0.";
-					break;
-				case Avatar::EYES::AMANDE:
-					data += "1.";
-					break;
-				case Avatar::EYES::GROS:
-					data += "2.";
-					break;
-				default:
-					break;
-				};
-			}
-			else {
-				data += "1.";
-				// hair
-				switch (m_avatar.m_hair)
-				{
-				case Avatar::HAIR::MIXTE:
-					data += "0.";
-					break;
-				case Avatar::HAIR::MI_LONG:
-					data += "5.";
-					break;
-				case Avatar::HAIR::FRANGE:
-					data += "6.";
-					break;
-				case Avatar::HAIR::AU_BOL:
-					data += "7.";
-					break;
-				case Avatar::HAIR::PONYTAIL:
-					data += "8.";
-					break;
-				default:
-					break;
-				};
-				// eyes
-				switch (m_avatar.m_eyes)
-				{
-				case Avatar::EYES::MANGA:
-					data += "0.";
-					break;
-				case Avatar::EYES::EGYPTE:
-					data += "3.";
-					break;
-				case Avatar::EYES::MASCARA:
-					data += "4.";
-					break;
-				default:
-					break;
-				};
-			}
-			// mouth
-			switch (m_avatar.m_mouth)
-			{
-			case Avatar::MOUTH::PETITE:
-				data += "0.";
-				break;
-			case Avatar::MOUTH::MOYENNE:
-				data += "1.";
-				break;
-			case Avatar::MOUTH::GRANDE:
-				data += "2.";
-				break;
-			};
-			// skin color
-			data += std::to_string(m_avatar.m_skin_color_id) + ".";
-			// hair color
-			data += std::to_string(m_avatar.m_hair_color_id) + ".";
-			// eyes color
-			data += std::to_string(m_avatar.m_eyes_color_id);
-
-			g_msg2server_mutex.lock();
-			g_msg2server_queue.emplace(data);
-			g_msg2server_mutex.unlock();
+			AvatarData avatar;
+			avatar.gender = (m_avatar.m_gender == Avatar::GENDER::MALE) ? 0 : 1;
+			avatar.hair = static_cast<std::uint8_t>(m_avatar.m_hair);
+			avatar.eyes = static_cast<std::uint8_t>(m_avatar.m_eyes);
+			avatar.mouth = static_cast<std::uint8_t>(m_avatar.m_mouth);
+			avatar.skin_color = static_cast<std::uint8_t>(m_avatar.m_skin_color_id);
+			avatar.hair_color = static_cast<std::uint8_t>(m_avatar.m_hair_color_id);
+			avatar.eyes_color = static_cast<std::uint8_t>(m_avatar.m_eyes_color_id);
+
+			// the hello packet is sent by the network thread once connected
+			std::array<std::uint8_t, PACKET_MAX_SIZE> packet;
+			post_message(MESSAGE::CONNECT, packet.data(), encode_hello(packet.data(), packet.size(), m_writer.m_textInput[0], avatar));
 			
 			// stop focus pseudo input
 			home_page.get_layer(12).get_sprite(33)->use_background_img();
@@ -1577,16 +1330,12 @@ void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int
 		else if (sprite_id == 35 && inputs.test(2) && inputs.test(9)) // clicked on play
 		{
 			g_search_opponent = true;
-			g_msg2server_mutex.lock();
-			g_msg2server_queue.emplace("1");
-			g_msg2server_mutex.unlock();
+			post_command(PACKET::SEARCH_OPPONENT);
 		}
 		else if (sprite_id == 36 && inputs.test(2) && inputs.test(9)) // clicked on stop search opponent
 		{
 			g_search_opponent = false;
-			g_msg2server_mutex.lock();
-			g_msg2server_queue.emplace("2");
-			g_msg2server_mutex.unlock();
+			post_command(PACKET::STOP_SEARCH);
 		}
 		else if (inputs.test(2) && inputs.test(9))
 		{
@@ -1619,25 +1368,13 @@ void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int
 		{
 			game_page.get_layer(1).get_sprite(sprite_id)->use_background_img_selected();
 			m_mouse->use_hover();
+			// arrow sprites 3 to 6 follow the DIRECTION ordering, the outcomes are already computed
+			m_board.preview(sprite_id - 3);
 
-			if (sprite_id == 3)
-			{
-				m_move = MOVE::UP;
-			}
-			else if (sprite_id == 4)
+			if (inputs.test(2) && inputs.test(9)) // clicked on an arrow
 			{
-				m_move = MOVE::DOWN;
+				play_action(Action{ ACTION::MOVE, static_cast<std::uint8_t>(sprite_id - 3), NO_CELL });
 			}
-			else if (sprite_id == 5)
-			{
-				m_move = MOVE::RIGHT;
-			}
-			else if (sprite_id == 6)
-			{
-				m_move = MOVE::LEFT;
-			}
-
-			set_animationTimer();
 		}
 		else
 		{
@@ -1645,6 +1382,7 @@ void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int
 			game_page.get_layer(1).get_sprite(4)->use_background_img();
 			game_page.get_layer(1).get_sprite(5)->use_background_img();
 			game_page.get_layer(1).get_sprite(6)->use_background_img();
+			m_board.preview(-1);
 			m_mouse->use_normal();
 		}
 		if (sprite_id == 7) // hovered abandon
@@ -1665,15 +1403,15 @@ void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int
 				switch (card_id) {
 				case 100:
 					desc_id = m_cards.m_slot[0];
-					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id].id);
+					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id]);
 					break;
 				case 101:
 					desc_id = m_cards.m_slot[1];
-					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id].id);
+					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id]);
 					break;
 				case 102:
 					desc_id = m_cards.m_slot[2];
-					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id].id);
+					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id]);
 					break;
 				default:
 					break;
@@ -1686,26 +1424,49 @@ void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int
 				switch (card_id) {
 				case 200:
 					desc_id = m_cards.m_slot[8];
-					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id].id);
+					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id]);
 					break;
 				case 201:
 					desc_id = m_cards.m_slot[9];
-					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id].id);
+					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id]);
 					break;
 				case 202:
 					desc_id = m_cards.m_slot[10];
-					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id].id);
+					game_page.get_layer(3).get_sprite(9)->set_background_img_gl(m_cards.m_description[desc_id]);
 					break;
 				default:
 					break;
 				};
 				game_page.get_layer(3).set_visibility(true);
 			}
+			int first{ (m_fruit == 0) ? 100 : 200 };
+			if (card_id >= first && card_id <= first + 2 && inputs.test(2) && inputs.test(9)) // clicked on one of my cards
+			{
+				int card{ m_cards.m_slot[card_id - first + ((m_fruit == 0) ? 0 : 8)] };
+				if (card >= 0 && card_needs_target(static_cast<CARD>(card)))
+				{
+					m_selected_card = card; // played on the next click on the board
+				}
+				else if (card >= 0)
+				{
+					play_action(Action{ ACTION::CARD, static_cast<std::uint8_t>(card), NO_CELL });
+				}
+			}
 		}
 		else
 		{
 			m_mouse->use_normal();
 			game_page.get_layer(3).set_visibility(false);
+
+			if (m_selected_card >= 0 && inputs.test(2) && inputs.test(9)) // clicked on the target of the selected card
+			{
+				int cell{ m_board.hovered_cell(mouse_pos[0], mouse_pos[1]) };
+				if (cell >= 0)
+				{
+					play_action(Action{ ACTION::CARD, static_cast<std::uint8_t>(m_selected_card), static_cast<std::uint8_t>(cell) });
+				}
+				m_selected_card = -1;
+			}
 		}
 		if (sprite_id == 7 && inputs.test(2) && inputs.test(9)) // clicked on abandon
 		{
@@ -1715,10 +1476,7 @@ void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int
 			// use police of size 20
 			textRenderer->use_police(0);
 			// send abandon message to server
-			std::string data("3");
-			g_msg2server_mutex.lock();
-			g_msg2server_queue.emplace(data);
-			g_msg2server_mutex.unlock();
+			post_command(PACKET::GIVE_UP);
 
 			// stop focus chat input
 			m_writer.m_cursor.m_focus = 2; // 0 = pseudo, 1 = chat, 2 = not writting
@@ -1731,6 +1489,7 @@ void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int
 		{
 			game_page.get_layer(2).get_sprite(sprite_id)->use_background_img_selected();
 			m_writer.m_cursor.m_focus = 1; // 0 = pseudo, 1 = chat, 2 = not writting
+			m_writer.m_cursor.m_pos = textRenderer->get_cursor_pos(m_writer.m_textInput[1], 240 + 13, 1, mouse_pos[0]);
 		}
 		else if (inputs.test(2) && inputs.test(9))
 		{
@@ -1746,19 +1505,215 @@ void Game::updateUI(std::bitset<10>& inputs, char* text_input, int screenW, int
 		}
 		else if (m_writer.m_cursor.m_focus == 1 && inputs.test(5)) // pressed enter keyboard => send chat message
 		{
-			std::string data("4:");
-			data += m_writer.m_textInput[1];
-			g_msg2server_mutex.lock();
-			g_msg2server_queue.emplace(data);
-			g_msg2server_mutex.unlock();
+			if (!m_writer.m_textInput[1].empty())
+			{
+				std::array<std::uint8_t, PACKET_MAX_SIZE> packet;
+				post_message(MESSAGE::PACKET, packet.data(), encode_chat(packet.data(), packet.size(), m_writer.m_textInput[1]));
+			}
 			// clear chat input
 			m_writer.m_textInput[1].clear();
 			// reset cursor pos to zero
 			m_writer.m_cursor.m_pos = 0;
 		}
+
+		// typing indicator, only sent when the state changes, reliably and in order with the chat
+		bool typing{ !m_writer.m_textInput[1].empty() };
+		if (typing != m_typing)
+		{
+			m_typing = typing;
+			std::array<std::uint8_t, PACKET_HEADER_SIZE + 1> packet;
+			post_message(MESSAGE::PACKET, packet.data(), encode_typing(packet.data(), packet.size(), typing));
+		}
+	}
+}
+
+void Game::set_network_client(NetworkClient* network)
+{
+	m_network = network;
+}
+
+void Game::post_message(MESSAGE code, const std::uint8_t* data, std::size_t size)
+{
+	if (size == 0)
+	{
+		std::cerr << "Error: packet too large, message dropped.\n";
+		return;
+	}
+	if (!enqueue_message(g_msg2server_queue, code, data, size))
+	{
+		std::cerr << "Error: message queue to the network thread is full, message dropped.\n";
+		return;
+	}
+	// the network thread sleeps until there is work to do
+	if (m_network)
+	{
+		m_network->wake_up();
+	}
+}
+
+void Game::post_command(PACKET type)
+{
+	std::array<std::uint8_t, PACKET_HEADER_SIZE> packet;
+	post_message(MESSAGE::PACKET, packet.data(), encode_command(packet.data(), packet.size(), type));
+}
+
+void Game::poll_messages()
+{
+	Message* message;
+	while ((message = g_msg2client_queue.front()) != nullptr)
+	{
+		if (message->m_code == MESSAGE::CONNECTION_RESULT)
+		{
+			if (message->view() == "0") // connection failed
+			{
+				g_try_connection = false;
+			}
+		}
+		else if (message->m_code == MESSAGE::CHAT)
+		{
+			m_writer.m_chatLog.push(message->view());
+		}
+		else if (message->m_code == MESSAGE::PACKET)
+		{
+			std::cerr << "Error: unexpected packet received from the network thread.\n";
+		}
+		g_msg2client_queue.pop();
+	}
+
+	// only the latest snapshot matters, deltas are applied in order on top of it
+	GameUpdate* update;
+	while ((update = g_game_update_queue.front()) != nullptr)
+	{
+		if (update->m_type == UPDATE::SNAPSHOT)
+		{
+			// a new game not displayed yet stays a new game, even if a resynchronization replaces it
+			bool new_game{ m_snapshot.version != m_snapshot_version && m_snapshot.new_game };
+			m_snapshot = update->m_snapshot;
+			m_snapshot.new_game = m_snapshot.new_game || new_game;
+		}
+		else if (update->m_type == UPDATE::DELTA)
+		{
+			apply_delta(update->m_delta);
+		}
+		else if (m_fruit >= 0)
+		{
+			m_opponent_left = true;
+			m_writer.m_chatLog.push("Votre adversaire a quitt\xC3\xA9 la partie.");
+			show_prediction();
+		}
+		g_game_update_queue.pop();
 	}
 }
 
+void Game::apply_delta(const BoardDelta& delta)
+{
+	// the board already shows the snapshot, only the changed cells are updated, otherwise draw() will apply the patched snapshot
+	bool displayed{ m_snapshot.version == m_snapshot_version };
+	m_snapshot.sequence = delta.sequence;
+	m_snapshot.turn = delta.turn;
+	m_snapshot.effects = delta.effects;
+	m_snapshot.pending = delta.pending;
+	m_snapshot.solo = delta.solo;
+	m_snapshot.turn_count = delta.turn_count;
+	m_snapshot.ack = delta.ack;
+	for (int i{ 0 }; i < delta.count; ++i)
+	{
+		m_snapshot.board[delta.cells[i].index] = delta.cells[i].cell;
+	}
+	if (displayed)
+	{
+		// a move of the opponent, mine were animated when they were played
+		if (m_state.m_turn != m_fruit)
+		{
+			GameState played{ m_state };
+			MoveSteps steps;
+			apply_action(played, Action{ ACTION::MOVE, delta.direction, NO_CELL }, &steps);
+			m_board.animate(m_state.m_board, steps);
+		}
+		patch_state(m_state, delta, m_fruit);
+		reconcile(delta.ack);
+	}
+}
+
+void Game::apply_snapshot(const GameSnapshot& snapshot)
+{
+	// my fruit
+	m_fruit = snapshot.fruit;
+	// turn
+	m_turn = snapshot.turn;
+	// set opponent name and avatar
+	std::string opponent_name(snapshot.opponent_name());
+	if (m_fruit == 0) {
+		m_pseudo_orange = m_writer.m_textInput[0];
+		m_pseudo_banane = opponent_name;
+	}
+	else {
+		m_pseudo_banane = m_writer.m_textInput[0];
+		m_pseudo_orange = opponent_name;
+	}
+	m_avatar_opponent.set_attributes(snapshot.opponent_avatar);
+	// board, cards and turn, with the actions the server did not process yet
+	load_state(m_state, snapshot);
+	reconcile(snapshot.ack);
+}
+
+void Game::play_action(const Action& action)
+{
+	if (m_fruit < 0 || m_opponent_left || m_predicted.m_turn != m_fruit || m_pending_count == PENDING_ACTIONS || !is_legal(m_predicted, action))
+		return;
+
+	std::array<std::uint8_t, PACKET_HEADER_SIZE + 2> packet;
+	std::size_t size;
+	if (action.type == ACTION::MOVE)
+		size = encode_move(packet.data(), packet.size(), static_cast<DIRECTION>(action.value));
+	else
+		size = encode_card(packet.data(), packet.size(), static_cast<CARD>(action.value), action.target);
+	post_message(MESSAGE::PACKET, packet.data(), size);
+
+	// shown right away, corrected by reconcile() if the server disagrees (hidden traps, confiscation)
+	m_action_count++;
+	m_pending[m_pending_count++] = PendingAction{ action, m_action_count };
+	MoveSteps steps;
+	BitBoard before{ m_predicted.m_board };
+	apply_action(m_predicted, action, &steps);
+	m_board.animate(before, steps);
+	show_prediction();
+}
+
+void Game::reconcile(std::uint16_t ack)
+{
+	// the actions the server acknowledged are part of m_state now, the ack also counts the actions it refused
+	// and the ones dropped below, the pending actions are confirmed by number
+	std::size_t confirmed{ 0 };
+	while (confirmed < m_pending_count && static_cast<std::int16_t>(ack - m_pending[confirmed].number) >= 0)
+		confirmed++;
+	std::copy(m_pending.begin() + confirmed, m_pending.begin() + m_pending_count, m_pending.begin());
+	m_pending_count -= confirmed;
+
+	// replay the others on top of the confirmed state, an action that became illegal will be refused by the server too,
+	// as well as every action once the turn has passed to the opponent
+	m_predicted = m_state;
+	for (std::size_t i{ 0 }; i < m_pending_count; ++i)
+	{
+		if (m_predicted.m_turn != m_fruit || !is_legal(m_predicted, m_pending[i].action))
+		{
+			m_pending_count = i;
+			break;
+		}
+		apply_action(m_predicted, m_pending[i].action);
+	}
+	show_prediction();
+}
+
+void Game::show_prediction()
+{
+	m_turn = m_predicted.m_turn;
+	m_winner = m_opponent_left ? m_fruit : winner(m_predicted);
+	m_board.set_bits(m_predicted.m_board);
+	m_cards.set_hand(m_fruit, m_predicted.m_cards[m_fruit]);
+	m_board.set_previews(m_predicted, m_fruit >= 0 && m_turn == m_fruit && m_winner == -1 && m_pending_count < PENDING_ACTIONS);
+}
+
 void Game::swap_gender_features(Avatar::GENDER from, Avatar::GENDER to)
 {
 	// swap hair
@@ -1803,66 +1758,6 @@ void Game::swap_gender_features(Avatar::GENDER from, Avatar::GENDER to)
 	}
 }
 
-void Game::set_animationTimer()
-{
-	float animationLength{ 0.25f };
-	float collideStep{ 0.125f };
-	float collide{ 0.0f };
-	if (m_move == MOVE::UP)
-	{
-		std::array<int, 8> initiate;
-		for (int i{ 0 }; i < 8; ++i)
-		{
-			int line{ 7 };
-			while (m_board.m_fruit[line][i].m_type != m_fruit)
-			{
-				line--;
-			}
-			initiate[i] = line;
-		}
-
-	}
-	else if (m_move == MOVE::DOWN)
-	{
-		std::array<int, 8> initiate;
-		for (int i{ 0 }; i < 8; ++i)
-		{
-			int line{ 0 };
-			while (m_board.m_fruit[line][i].m_type != m_fruit)
-			{
-				line++;
-			}
-			initiate[i] = line;
-		}
-	}
-	else if (m_move == MOVE::RIGHT)
-	{
-		std::array<int, 8> initiate;
-		for (int i{ 0 }; i < 8; ++i)
-		{
-			int col{ 0 };
-			while (m_board.m_fruit[i][col].m_type != m_fruit)
-			{
-				col++;
-			}
-			initiate[i] = col;
-		}
-	}
-	else if (m_move == MOVE::LEFT)
-	{
-		std::array<int, 8> initiate;
-		for (int i{ 0 }; i < 8; ++i)
-		{
-			int col{ 7 };
-			while (m_board.m_fruit[i][col].m_type != m_fruit)
-			{
-				col--;
-			}
-			initiate[i] = col;
-		}
-	}
-}
-
 void Game::directionalShadowPass(int index, float delta, DRAWING_MODE mode)
 {
 	graphics.getShadowMappingShader().use();
@@ -0,0 +1,247 @@
+#include "local_opponent.hpp"
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <ctime>
+
+static MctsOptions with_time(MctsOptions options, double seconds)
+{
+	options.seconds = seconds;
+	return options;
+}
+
+LocalOpponent::LocalOpponent(AI ai, double think_time, const MctsOptions& mcts, unsigned int seed) :
+	m_run(nullptr),
+	m_ai(ai),
+	m_think_time(think_time),
+	m_rng(seed),
+	m_alpha_beta(),
+	m_mcts(with_time(mcts, think_time)),
+	m_state{},
+	m_fruit(-1),
+	m_sequence(0),
+	m_snapshot_version(0),
+	m_ack(0),
+	m_replay_dir(),
+	m_replay(),
+	m_games(0)
+{}
+
+void LocalOpponent::run(std::atomic<bool>& run)
+{
+	m_run = &run;
+	while (run)
+	{
+		Message* message{ g_msg2server_queue.front() };
+		if (!message) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(OPPONENT_IDLE_SLEEP));
+			continue;
+		}
+
+		if (message->m_code == MESSAGE::CONNECT) {
+			// nothing to connect to, the hello packet that comes with the message gives the nickname
+			g_connected = true;
+			enqueue_message(g_msg2client_queue, MESSAGE::CONNECTION_RESULT, "1");
+		}
+		if (message->m_code == MESSAGE::CONNECT || message->m_code == MESSAGE::PACKET) {
+			std::size_t offset{ 0 };
+			while (offset < static_cast<std::size_t>(message->m_size))
+			{
+				PacketReader reader(message->m_data.data() + offset, message->m_size - offset);
+				PacketHeader header;
+				if (!reader.read_header(header)) {
+					std::cerr << "Error: malformed packet posted to the local opponent.\n";
+					break;
+				}
+				on_packet(reader, header);
+				offset += PACKET_HEADER_SIZE + header.size;
+			}
+		}
+		g_msg2server_queue.pop();
+	}
+}
+
+void LocalOpponent::on_packet(PacketReader& reader, const PacketHeader& header)
+{
+	switch (header.type)
+	{
+		case PACKET::HELLO:
+		{
+			std::string_view nickname;
+			AvatarData avatar;
+			if (decode_hello(reader, nickname, avatar)) {
+				m_nickname = nickname;
+			}
+			break;
+		}
+		case PACKET::SEARCH_OPPONENT:
+			start_game();
+			break;
+		case PACKET::GIVE_UP:
+			m_fruit = -1;
+			m_replay.close();
+			break;
+		case PACKET::MOVE:
+		{
+			DIRECTION direction;
+			if (decode_move(reader, direction)) {
+				on_action(Action{ ACTION::MOVE, static_cast<std::uint8_t>(direction), NO_CELL });
+			}
+			break;
+		}
+		case PACKET::CARD:
+		{
+			CARD card;
+			std::uint8_t target;
+			if (decode_card(reader, card, target)) {
+				on_action(Action{ ACTION::CARD, static_cast<std::uint8_t>(card), target });
+			}
+			break;
+		}
+		case PACKET::SNAPSHOT_REQUEST:
+			if (m_fruit >= 0) {
+				publish_state(false);
+			}
+			break;
+		case PACKET::CHAT:
+		{
+			std::string_view text;
+			if (decode_chat(reader, text) && !text.empty()) {
+				std::string line{ m_nickname + " : " };
+				line += text;
+				enqueue_message(g_msg2client_queue, MESSAGE::CHAT, line);
+				if (m_fruit >= 0)
+					m_replay.chat(m_fruit, text);
+			}
+			break;
+		}
+		default: // STOP_SEARCH and TYPING mean nothing without a remote opponent
+			break;
+	}
+}
+
+void LocalOpponent::start_game()
+{
+	deal_state(m_state, m_rng);
+	m_fruit = static_cast<int>(m_rng() & 1);
+	m_sequence = 0;
+	m_ack = 0;
+	g_opponent_typing = false;
+	if (!m_replay_dir.empty())
+	{
+		std::string path{ m_replay_dir + "/offline_" + std::to_string(std::time(nullptr)) + "_" + std::to_string(m_games) + REPLAY_EXTENSION };
+		m_replay.open(path, m_state, (m_fruit == 0) ? m_nickname : std::string(OPPONENT_NAME), (m_fruit == 1) ? m_nickname : std::string(OPPONENT_NAME));
+	}
+	m_games++;
+	publish_state(true);
+	play_opponent();
+}
+
+void LocalOpponent::on_action(const Action& action)
+{
+	if (m_fruit < 0)
+		return;
+	m_ack++;
+	if (m_state.m_turn != m_fruit || !is_legal(m_state, action))
+	{
+		std::cerr << "Error: illegal action posted to the local opponent.\n";
+		publish_state(false);
+		return;
+	}
+	play(action);
+	play_opponent();
+}
+
+void LocalOpponent::play(const Action& action)
+{
+	std::array<std::uint8_t, BOARD_CELLS> before;
+	visible_cells(m_state, m_fruit, before);
+	apply_action(m_state, action);
+	m_replay.action(action);
+	if (winner(m_state) != -1)
+		m_replay.close();
+	m_sequence++;
+	// the hands are not part of the deltas
+	if (action.type == ACTION::CARD)
+		publish_state(false);
+	else
+		publish_delta(before, static_cast<DIRECTION>(action.value));
+}
+
+void LocalOpponent::play_opponent()
+{
+	while (m_fruit >= 0 && winner(m_state) == -1 && m_state.m_turn != m_fruit && *m_run)
+	{
+		// the search only sees what the opponent would see : neither the traps nor the hand of the player
+		GameState view{ m_state };
+		restrict_view(view, 1 - m_fruit);
+		play(think(view));
+	}
+}
+
+Action LocalOpponent::think(const GameState& view)
+{
+	if (m_ai == AI::ALPHA_BETA)
+		return m_alpha_beta.search(view, m_think_time).action;
+
+	MctsResult result{ m_mcts.search(view) };
+	std::cout << "MCTS : " << result.playouts << " playouts in " << result.time << " s on " << result.threads << " threads ("
+		<< static_cast<std::uint64_t>(result.playouts_per_second) << " playouts/s), win chance " << result.value << "\n";
+	return result.action;
+}
+
+// the render thread frees a slot every frame, the opponent waits for it instead of losing an update
+GameUpdate* LocalOpponent::acquire_update()
+{
+	GameUpdate* update;
+	while ((update = g_game_update_queue.acquire()) == nullptr && *m_run)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(OPPONENT_IDLE_SLEEP));
+	}
+	return update;
+}
+
+void LocalOpponent::publish_state(bool new_game)
+{
+	GameUpdate* update{ acquire_update() };
+	if (!update)
+		return;
+	GameSnapshot& snapshot{ update->m_snapshot };
+	store_state(m_state, m_fruit, snapshot);
+	snapshot.sequence = m_sequence;
+	snapshot.ack = m_ack;
+	snapshot.set_opponent_name(OPPONENT_NAME);
+	snapshot.opponent_avatar = AvatarData{ 0, 1, 0, 1, 3, 3, 0 };
+	snapshot.version = ++m_snapshot_version;
+	snapshot.new_game = new_game;
+	update->m_type = UPDATE::SNAPSHOT;
+	g_game_update_queue.commit();
+	g_game_found = true;
+}
+
+void LocalOpponent::publish_delta(const std::array<std::uint8_t, BOARD_CELLS>& before, DIRECTION direction)
+{
+	GameUpdate* update{ acquire_update() };
+	if (!update)
+		return;
+	BoardDelta& delta{ update->m_delta };
+	delta.sequence = m_sequence;
+	delta.turn = m_state.m_turn;
+	delta.effects = m_state.m_effects;
+	delta.pending = m_state.m_pending;
+	delta.solo = m_state.m_solo;
+	delta.turn_count = m_state.m_turn_count;
+	delta.ack = m_ack;
+	delta.direction = static_cast<std::uint8_t>(direction);
+	delta.count = 0;
+	for (int index{ 0 }; index < BOARD_CELLS; ++index)
+	{
+		std::uint8_t cell{ visible_cell(m_state, index, m_fruit) };
+		if (cell != before[index])
+		{
+			delta.cells[delta.count++] = CellChange{ static_cast<std::uint8_t>(index), cell };
+		}
+	}
+	update->m_type = UPDATE::DELTA;
+	g_game_update_queue.commit();
+}
@@ -0,0 +1,618 @@
+// headless stand-in for the game server, speaks the protocol of protocol.hpp over ENet
+// usage : frutibandas_server [--port 7777] [--bot-delay 0.5] [--bot-think 0] [--chat-rate 0] [--report 5] [--seed 0] [--drop-delta 0]
+//                            [--replays <directory>]
+// two players searching at the same time are matched together, a player left alone is matched
+// against a simulated opponent after --bot-delay seconds
+// the simulated opponent moves at random, or searches with AlphaBeta for --bot-think seconds per action
+// --chat-rate makes the simulated opponent send that many chat messages per second, to load the client
+// every --report seconds the server prints the round trip time of the connected peers and its throughput
+// --drop-delta N skips every Nth board delta, to exercise the snapshot fallback of the client
+// moves and cards are checked and applied with rules.hpp, the players receive the cells that changed
+// --replays writes every game with the chat of its players in the directory, see replay.hpp
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <array>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <enet/enet.h>
+#include "protocol.hpp"
+#include "rules.hpp"
+#include "alpha_beta.hpp"
+#include "replay.hpp"
+
+#define DEFAULT_PORT 7777
+#define MAX_CLIENTS 32
+#define SERVICE_TIMEOUT 5 // ms
+#define BOT_NAME "Robot"
+
+struct ServerOptions
+{
+	int port{ DEFAULT_PORT };
+	double bot_delay{ 0.5 }; // seconds before a lonely player is matched against the simulated opponent
+	double bot_think{ 0.0 }; // seconds of search per action of the simulated opponent, 0 => random moves
+	double chat_rate{ 0.0 }; // chat messages per second sent by the simulated opponent
+	double report_interval{ 5.0 }; // seconds
+	unsigned int seed{ 0 };
+	int drop_delta{ 0 };
+	std::string replay_dir; // empty => no replay
+};
+
+struct Match;
+
+struct Player
+{
+	ENetPeer* peer{ nullptr };
+	std::string nickname;
+	AvatarData avatar{};
+	bool searching{ false };
+	double search_start{ 0.0 };
+	Match* match{ nullptr };
+	int fruit{ -1 }; // 0 => orange, 1 => banane
+	std::uint16_t ack{ 0 }; // moves and cards received in the current game, echoed in the states and deltas
+	double bot_chat_time{ 0.0 };
+	int bot_chat_count{ 0 };
+};
+
+struct Match
+{
+	GameState state;
+	std::uint32_t sequence{ 0 }; // board sequence number, incremented by every action
+	std::array<Player*, 2> player{}; // indexed by fruit, nullptr => simulated opponent
+	double bot_move_time{ 0.0 }; // when the simulated opponent plays its next move, 0 if not its turn
+	ReplayWriter replay; // closed at the end of the game or when the match is destroyed
+};
+
+struct ServerStats
+{
+	std::uint64_t packets_in{ 0 };
+	std::uint64_t packets_out{ 0 };
+	std::uint64_t bytes_in{ 0 };
+	std::uint64_t bytes_out{ 0 };
+	std::uint64_t games{ 0 };
+};
+
+class LocalServer
+{
+	public:
+		LocalServer(const ServerOptions& options);
+		~LocalServer();
+		void run();
+
+	private:
+		double now() const;
+		void on_connect(ENetPeer* peer);
+		void on_disconnect(ENetPeer* peer);
+		void on_receive(ENetPeer* peer, const ENetPacket* packet);
+		void on_packet(Player& player, PacketReader& reader, const PacketHeader& header, const std::uint8_t* data);
+		void on_chat(Player& player, std::string_view text);
+		void leave_game(Player& player);
+		void start_game(Player& a, Player* b);
+		void on_action(Player& player, const Action& action);
+		void play_action(Match& match, const Action& action);
+		void send_state(Match& match, int fruit, PACKET type);
+		void update_bots();
+		void send(ENetPeer* peer, const std::uint8_t* data, std::size_t size);
+		void report();
+
+	private:
+		ServerOptions m_options;
+		ENetHost* m_host;
+		std::vector<std::unique_ptr<Player>> m_players;
+		std::vector<std::unique_ptr<Match>> m_matches;
+		std::mt19937 m_rng;
+		AlphaBeta m_ai;
+		ServerStats m_stats;
+		std::chrono::steady_clock::time_point m_start;
+		double m_last_report;
+};
+
+LocalServer::LocalServer(const ServerOptions& options) :
+	m_options(options),
+	m_host(nullptr),
+	m_rng(options.seed),
+	m_start(std::chrono::steady_clock::now()),
+	m_last_report(0.0)
+{
+	if (enet_initialize() != 0)
+	{
+		std::cerr << "Error: an error occured while initializing ENet.\n";
+		std::exit(EXIT_FAILURE);
+	}
+	atexit(enet_deinitialize);
+
+	ENetAddress address;
+	address.host = ENET_HOST_ANY;
+	address.port = static_cast<enet_uint16>(m_options.port);
+	m_host = enet_host_create(&address, MAX_CLIENTS, CHANNEL_COUNT, 0, 0);
+	if (m_host == nullptr)
+	{
+		std::cerr << "Error: could not create the server host on port " << m_options.port << ".\n";
+		std::exit(EXIT_FAILURE);
+	}
+	std::cout << "Listening on port " << m_options.port << "\n";
+}
+
+LocalServer::~LocalServer()
+{
+	if (m_host)
+	{
+		enet_host_destroy(m_host);
+	}
+}
+
+double LocalServer::now() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+void LocalServer::run()
+{
+	ENetEvent event;
+	while (true)
+	{
+		while (enet_host_service(m_host, &event, SERVICE_TIMEOUT) > 0)
+		{
+			switch (event.type)
+			{
+				case ENET_EVENT_TYPE_CONNECT:
+					on_connect(event.peer);
+					break;
+				case ENET_EVENT_TYPE_DISCONNECT:
+					on_disconnect(event.peer);
+					break;
+				case ENET_EVENT_TYPE_RECEIVE:
+					m_stats.packets_in++;
+					m_stats.bytes_in += event.packet->dataLength;
+					on_receive(event.peer, event.packet);
+					enet_packet_destroy(event.packet);
+					break;
+				default:
+					break;
+			}
+		}
+
+		update_bots();
+
+		if (m_options.report_interval > 0.0 && now() - m_last_report >= m_options.report_interval)
+		{
+			report();
+		}
+	}
+}
+
+void LocalServer::on_connect(ENetPeer* peer)
+{
+	m_players.push_back(std::make_unique<Player>());
+	m_players.back()->peer = peer;
+	peer->data = m_players.back().get();
+	std::cout << "Client connected (" << m_players.size() << " online)\n";
+}
+
+void LocalServer::on_disconnect(ENetPeer* peer)
+{
+	Player* player{ static_cast<Player*>(peer->data) };
+	if (!player)
+		return;
+	leave_game(*player);
+	m_players.erase(std::remove_if(m_players.begin(), m_players.end(),
+		[player](const std::unique_ptr<Player>& p) { return p.get() == player; }), m_players.end());
+	peer->data = nullptr;
+	std::cout << "Client disconnected (" << m_players.size() << " online)\n";
+}
+
+void LocalServer::on_receive(ENetPeer* peer, const ENetPacket* packet)
+{
+	Player* player{ static_cast<Player*>(peer->data) };
+	if (!player)
+		return;
+
+	// clients batch the packets posted during a frame, each one starts with its header
+	std::size_t offset{ 0 };
+	while (offset < packet->dataLength)
+	{
+		PacketReader reader(packet->data + offset, packet->dataLength - offset);
+		PacketHeader header;
+		if (!reader.read_header(header))
+		{
+			std::cerr << "Error: malformed packet dropped.\n";
+			return;
+		}
+		on_packet(*player, reader, header, packet->data + offset);
+		offset += PACKET_HEADER_SIZE + header.size;
+	}
+}
+
+void LocalServer::on_packet(Player& player, PacketReader& reader, const PacketHeader& header, const std::uint8_t* data)
+{
+	switch (header.type)
+	{
+		case PACKET::HELLO:
+		{
+			std::string_view nickname;
+			if (decode_hello(reader, nickname, player.avatar)) {
+				player.nickname = nickname;
+			}
+			break;
+		}
+		case PACKET::SEARCH_OPPONENT:
+		{
+			if (player.match)
+				break;
+			// match with the first other player searching, if any
+			for (auto& other : m_players)
+			{
+				if (other.get() != &player && other->searching)
+				{
+					start_game(player, other.get());
+					return;
+				}
+			}
+			player.searching = true;
+			player.search_start = now();
+			break;
+		}
+		case PACKET::STOP_SEARCH:
+			player.searching = false;
+			break;
+		case PACKET::GIVE_UP:
+			leave_game(player);
+			break;
+		case PACKET::MOVE:
+		{
+			DIRECTION direction;
+			if (decode_move(reader, direction)) {
+				on_action(player, Action{ ACTION::MOVE, static_cast<std::uint8_t>(direction), NO_CELL });
+			}
+			break;
+		}
+		case PACKET::CARD:
+		{
+			CARD card;
+			std::uint8_t target;
+			if (decode_card(reader, card, target)) {
+				on_action(player, Action{ ACTION::CARD, static_cast<std::uint8_t>(card), target });
+			}
+			break;
+		}
+		case PACKET::SNAPSHOT_REQUEST:
+		{
+			if (player.match) {
+				send_state(*player.match, player.fruit, PACKET::GAME_STATE);
+			}
+			break;
+		}
+		case PACKET::CHAT:
+		{
+			std::string_view text;
+			if (decode_chat(reader, text)) {
+				on_chat(player, text);
+			}
+			break;
+		}
+		case PACKET::TYPING:
+		{
+			bool typing;
+			Player* opponent{ player.match ? player.match->player[1 - player.fruit] : nullptr };
+			if (decode_typing(reader, typing) && opponent) {
+				send(opponent->peer, data, PACKET_HEADER_SIZE + header.size);
+			}
+			break;
+		}
+		default:
+			std::cerr << "Error: unexpected packet type " << static_cast<int>(header.type) << ".\n";
+			break;
+	}
+}
+
+void LocalServer::on_chat(Player& player, std::string_view text)
+{
+	// the sender gets its own message back, the client only prints what the server sends
+	std::string line{ player.nickname + " : " };
+	line += text;
+	std::array<std::uint8_t, PACKET_MAX_SIZE> packet;
+	std::size_t size{ encode_chat(packet.data(), packet.size(), line) };
+	send(player.peer, packet.data(), size);
+	Player* opponent{ player.match ? player.match->player[1 - player.fruit] : nullptr };
+	if (opponent)
+	{
+		send(opponent->peer, packet.data(), size);
+	}
+	if (player.match)
+	{
+		player.match->replay.chat(player.fruit, text);
+	}
+}
+
+void LocalServer::leave_game(Player& player)
+{
+	player.searching = false;
+	Match* match{ player.match };
+	if (!match)
+		return;
+	std::array<std::uint8_t, PACKET_HEADER_SIZE> packet;
+	for (Player* p : match->player)
+	{
+		if (!p)
+			continue;
+		p->match = nullptr;
+		// the game is over for the one still there, it can search again
+		if (p != &player && winner(match->state) == -1)
+			send(p->peer, packet.data(), encode_command(packet.data(), packet.size(), PACKET::OPPONENT_LEFT));
+	}
+	m_matches.erase(std::remove_if(m_matches.begin(), m_matches.end(),
+		[match](const std::unique_ptr<Match>& m) { return m.get() == match; }), m_matches.end());
+}
+
+void LocalServer::start_game(Player& a, Player* b)
+{
+	m_matches.push_back(std::make_unique<Match>());
+	Match& match{ *m_matches.back() };
+
+	deal_state(match.state, m_rng);
+
+	int fruit_a{ static_cast<int>(m_rng() & 1) };
+	match.player[fruit_a] = &a;
+	match.player[1 - fruit_a] = b;
+	for (int fruit{ 0 }; fruit < 2; ++fruit)
+	{
+		Player* player{ match.player[fruit] };
+		if (!player)
+			continue;
+		player->searching = false;
+		player->match = &match;
+		player->fruit = fruit;
+		player->ack = 0;
+		player->bot_chat_time = now();
+		player->bot_chat_count = 0;
+		send_state(match, fruit, PACKET::GAME_INIT);
+	}
+	// the simulated opponent plays first if it has the oranges
+	match.bot_move_time = (match.player[0] == nullptr) ? now() + m_options.bot_delay : 0.0;
+
+	if (!m_options.replay_dir.empty())
+	{
+		std::string path{ m_options.replay_dir + "/game_" + std::to_string(std::time(nullptr)) + "_" + std::to_string(m_stats.games) + REPLAY_EXTENSION };
+		match.replay.open(path, match.state, match.player[0] ? match.player[0]->nickname : std::string(BOT_NAME),
+			match.player[1] ? match.player[1]->nickname : std::string(BOT_NAME));
+	}
+
+	m_stats.games++;
+	std::cout << "Game started : " << a.nickname << " vs " << (b ? b->nickname : std::string(BOT_NAME)) << "\n";
+}
+
+void LocalServer::on_action(Player& player, const Action& action)
+{
+	Match* match{ player.match };
+	if (!match)
+		return;
+	// counted even when refused, the client drops its prediction of the action once the state acknowledges it
+	player.ack++;
+	if (match->state.m_turn != player.fruit || !is_legal(match->state, action))
+	{
+		std::cerr << "Error: illegal action received from " << player.nickname << ".\n";
+		send_state(*match, player.fruit, PACKET::GAME_STATE);
+		return;
+	}
+	play_action(*match, action);
+}
+
+void LocalServer::play_action(Match& match, const Action& action)
+{
+	std::array<std::uint8_t, PACKET_MAX_SIZE> packet;
+
+	// every player sees its own traps only, so the changes are computed per player
+	std::array<std::array<std::uint8_t, BOARD_CELLS>, 2> before;
+	for (int viewer{ 0 }; viewer < 2; ++viewer)
+	{
+		visible_cells(match.state, viewer, before[viewer]);
+	}
+	apply_action(match.state, action);
+	match.replay.action(action);
+	match.sequence++;
+
+	if (action.type == ACTION::CARD)
+	{
+		// the hands changed, the deltas do not carry them
+		for (int viewer{ 0 }; viewer < 2; ++viewer)
+		{
+			if (match.player[viewer])
+				send_state(match, viewer, PACKET::GAME_STATE);
+		}
+	}
+	else
+	{
+		bool drop{ m_options.drop_delta > 0 && match.sequence % m_options.drop_delta == 0 };
+		for (int viewer{ 0 }; viewer < 2; ++viewer)
+		{
+			Player* player{ match.player[viewer] };
+			if (!player || drop)
+				continue;
+			BoardDelta delta;
+			delta.sequence = match.sequence;
+			delta.turn = match.state.m_turn;
+			delta.effects = match.state.m_effects;
+			delta.pending = match.state.m_pending;
+			delta.solo = match.state.m_solo;
+			delta.turn_count = match.state.m_turn_count;
+			delta.ack = player->ack;
+			delta.direction = action.value;
+			delta.count = 0;
+			for (int index{ 0 }; index < BOARD_CELLS; ++index)
+			{
+				std::uint8_t cell{ visible_cell(match.state, index, viewer) };
+				if (cell != before[viewer][index])
+				{
+					delta.cells[delta.count++] = CellChange{ static_cast<std::uint8_t>(index), cell };
+				}
+			}
+			send(player->peer, packet.data(), encode_board_delta(packet.data(), packet.size(), delta));
+		}
+	}
+
+	int result{ winner(match.state) };
+	if (result != -1)
+	{
+		std::cout << "Game over : " << ((result == 2) ? "draw" : ((result == 0) ? "orange wins" : "banane wins")) << "\n";
+		match.bot_move_time = 0.0;
+		match.replay.close();
+	}
+	else if (!match.player[match.state.m_turn])
+	{
+		match.bot_move_time = now() + m_options.bot_delay;
+	}
+}
+
+void LocalServer::send_state(Match& match, int fruit, PACKET type)
+{
+	Player* player{ match.player[fruit] };
+	Player* opponent{ match.player[1 - fruit] };
+	GameSnapshot state;
+	store_state(match.state, fruit, state);
+	state.sequence = match.sequence;
+	state.ack = player->ack;
+	state.set_opponent_name(opponent ? opponent->nickname : std::string(BOT_NAME));
+	state.opponent_avatar = opponent ? opponent->avatar : AvatarData{ 0, 1, 0, 1, 3, 3, 0 };
+	std::array<std::uint8_t, PACKET_MAX_SIZE> packet;
+	send(player->peer, packet.data(), encode_game_init(packet.data(), packet.size(), state, type));
+}
+
+void LocalServer::update_bots()
+{
+	double t{ now() };
+	for (auto& player : m_players)
+	{
+		// nobody else showed up, play against the simulated opponent
+		if (player->searching && t - player->search_start >= m_options.bot_delay)
+		{
+			start_game(*player, nullptr);
+		}
+	}
+
+	std::array<std::uint8_t, PACKET_MAX_SIZE> packet;
+	for (auto& match : m_matches)
+	{
+		if (match->bot_move_time > 0.0 && t >= match->bot_move_time)
+		{
+			match->bot_move_time = 0.0;
+			if (m_options.bot_think > 0.0)
+			{
+				// the search blocks the server loop, keep --bot-think short when many games run
+				GameState view{ match->state };
+				restrict_view(view, view.m_turn);
+				play_action(*match, m_ai.search(view, m_options.bot_think).action);
+			}
+			else
+			{
+				play_action(*match, Action{ ACTION::MOVE, static_cast<std::uint8_t>(m_rng() % 4), NO_CELL });
+			}
+		}
+
+		if (m_options.chat_rate <= 0.0)
+			continue;
+		for (Player* player : match->player)
+		{
+			// only games against the simulated opponent
+			if (!player || match->player[1 - player->fruit])
+				continue;
+			// catch up on the messages due since the last update, to keep the requested rate
+			while (t - player->bot_chat_time >= 1.0 / m_options.chat_rate)
+			{
+				std::string line{ std::string(BOT_NAME) + " : message " + std::to_string(player->bot_chat_count++) };
+				send(player->peer, packet.data(), encode_chat(packet.data(), packet.size(), line));
+				player->bot_chat_time += 1.0 / m_options.chat_rate;
+			}
+		}
+	}
+}
+
+void LocalServer::send(ENetPeer* peer, const std::uint8_t* data, std::size_t size)
+{
+	if (size == 0)
+	{
+		std::cerr << "Error: packet too large, not sent.\n";
+		return;
+	}
+	DELIVERY delivery{ packet_delivery(static_cast<PACKET>(data[1])) };
+	ENetPacket* packet = enet_packet_create(data, size, ENET_PACKET_FLAG_RELIABLE);
+	enet_peer_send(peer, static_cast<enet_uint8>(delivery), packet);
+	m_stats.packets_out++;
+	m_stats.bytes_out += size;
+}
+
+void LocalServer::report()
+{
+	double t{ now() };
+	double elapsed{ t - m_last_report };
+	m_last_report = t;
+
+	enet_uint32 rtt_min{ 0 }, rtt_max{ 0 };
+	double rtt_sum{ 0.0 };
+	for (std::size_t i{ 0 }; i < m_players.size(); ++i)
+	{
+		enet_uint32 rtt{ m_players[i]->peer->roundTripTime };
+		rtt_min = (i == 0 || rtt < rtt_min) ? rtt : rtt_min;
+		rtt_max = (rtt > rtt_max) ? rtt : rtt_max;
+		rtt_sum += rtt;
+	}
+
+	std::cout << "[" << static_cast<int>(t) << "s] clients " << m_players.size()
+		<< " | games " << m_stats.games;
+	if (!m_players.empty())
+	{
+		std::cout << " | rtt min/avg/max " << rtt_min << "/" << rtt_sum / m_players.size() << "/" << rtt_max << " ms";
+	}
+	std::cout << " | in " << m_stats.packets_in / elapsed << " pkt/s " << m_stats.bytes_in / elapsed << " B/s"
+		<< " | out " << m_stats.packets_out / elapsed << " pkt/s " << m_stats.bytes_out / elapsed << " B/s\n";
+
+	m_stats.packets_in = 0;
+	m_stats.packets_out = 0;
+	m_stats.bytes_in = 0;
+	m_stats.bytes_out = 0;
+}
+
+int main(int argc, char* argv[])
+{
+	ServerOptions options;
+	for (int i{ 1 }; i + 1 < argc; i += 2)
+	{
+		std::string arg{ argv[i] };
+		if (arg == "--port")
+			options.port = std::atoi(argv[i + 1]);
+		else if (arg == "--bot-delay")
+			options.bot_delay = std::atof(argv[i + 1]);
+		else if (arg == "--bot-think")
+			options.bot_think = std::atof(argv[i + 1]);
+		else if (arg == "--chat-rate")
+			options.chat_rate = std::atof(argv[i + 1]);
+		else if (arg == "--report")
+			options.report_interval = std::atof(argv[i + 1]);
+		else if (arg == "--seed")
+			options.seed = static_cast<unsigned int>(std::atoi(argv[i + 1]));
+		else if (arg == "--drop-delta")
+			options.drop_delta = std::atoi(argv[i + 1]);
+		else if (arg == "--replays")
+			options.replay_dir = argv[i + 1];
+		else
+		{
+			std::cerr << "Error: unknown option " << arg << ".\n";
+			return 1;
+		}
+	}
+	if (argc % 2 == 0)
+	{
+		std::cerr << "Error: no value for the option " << argv[argc - 1] << ".\n";
+		return 1;
+	}
+
+	LocalServer server(options);
+	server.run();
+
+	return 0;
+}
@@ -2,124 +2,192 @@
 #include <string>
 #include <memory>
 #include <utility>
+#include <string_view>
+#include <cstdlib>
+#include <chrono>
 #include "window.hpp"
 #include "game.hpp"
 #include "framebuffer.hpp"
 #include "editorUI.hpp"
 #include "allocation.hpp"
+#include "protocol.hpp"
+#include "network_stats.hpp"
+#include "local_opponent.hpp"
 
 #define SERVER "92.88.236.2"
 #define PORT 7777
+#define SERVICE_TIMEOUT 15 // maximum sleep (ms) between two ENet services while connected
+#define IDLE_TIMEOUT 1000 // maximum sleep (ms) while waiting for the player to connect
+#define AI_THINK_TIME 1.0 // seconds per action of the offline opponent
 
-void network_thread(bool& run, Writer& writer)
+// board synchronization state of the network thread
+struct ReceiveState
 {
-	NetworkClient client;
-	
+	std::uint32_t snapshot_version{ 0 }; // 0 is never published, the render thread starts with it
+	std::uint32_t board_sequence{ 0 }; // sequence number of the last board forwarded to the render thread
+	bool board_synced{ false }; // false until a snapshot arrives, and after a missed delta
+};
+
+// the board of the render thread is out of date, deltas are ignored until the full state arrives
+static void request_snapshot(ReceiveState& state, NetworkClient& client)
+{
+	state.board_synced = false;
+	std::array<std::uint8_t, PACKET_HEADER_SIZE> packet;
+	client.send_packet(packet.data(), encode_command(packet.data(), packet.size(), PACKET::SNAPSHOT_REQUEST));
+	client.flush_batches();
+}
+
+// processes one packet received from the server, the reader is positioned on its payload
+void handle_packet(PacketReader& reader, const PacketHeader& header, ReceiveState& state, NetworkClient& client)
+{
+	if (header.type == PACKET::GAME_INIT || header.type == PACKET::GAME_STATE) { // decoded in place into the next update slot
+		GameUpdate* update{ g_game_update_queue.acquire() };
+		if (!update) {
+			std::cerr << "Error: game update queue to the render thread is full, game state dropped, requesting a snapshot.\n";
+			request_snapshot(state, client);
+		}
+		else if (decode_game_init(reader, update->m_snapshot)) {
+			update->m_type = UPDATE::SNAPSHOT;
+			update->m_snapshot.version = ++state.snapshot_version;
+			update->m_snapshot.new_game = (header.type == PACKET::GAME_INIT);
+			state.board_sequence = update->m_snapshot.sequence;
+			state.board_synced = true;
+			g_game_update_queue.commit();
+			g_game_found = true;
+			if (header.type == PACKET::GAME_INIT) {
+				g_opponent_typing = false;
+			}
+		}
+	}
+	else if (header.type == PACKET::BOARD_DELTA) { // only the changed cells
+		if (!state.board_synced) {
+			return; // waiting for the snapshot
+		}
+		GameUpdate* update{ g_game_update_queue.acquire() };
+		if (!update || !decode_board_delta(reader, update->m_delta) || update->m_delta.sequence != state.board_sequence + 1) {
+			// a delta is missing, ask for the full state and ignore deltas until it arrives
+			std::cerr << "Error: board delta lost, requesting a snapshot.\n";
+			request_snapshot(state, client);
+			return;
+		}
+		update->m_type = UPDATE::DELTA;
+		state.board_sequence = update->m_delta.sequence;
+		g_game_update_queue.commit();
+	}
+	else if (header.type == PACKET::OPPONENT_LEFT) { // in order with the states of the game it ends
+		GameUpdate* update{ g_game_update_queue.acquire() };
+		if (!update) {
+			std::cerr << "Error: game update queue to the render thread is full, end of game dropped.\n";
+			return;
+		}
+		update->m_type = UPDATE::OPPONENT_LEFT;
+		g_game_update_queue.commit();
+		g_opponent_typing = false;
+	}
+	else if (header.type == PACKET::TYPING) { // opponent typing indicator
+		bool typing;
+		if (decode_typing(reader, typing)) {
+			g_opponent_typing = typing;
+		}
+	}
+	else if (header.type == PACKET::CHAT) { // game chat
+		std::string_view text;
+		if (decode_chat(reader, text) && !text.empty()) {
+			// the chat log belongs to the render thread
+			if (!enqueue_message(g_msg2client_queue, MESSAGE::CHAT, text)) {
+				std::cerr << "Error: message queue to the render thread is full, chat line dropped.\n";
+			}
+		}
+	}
+}
+
+void network_thread(std::atomic<bool>& run, NetworkClient& client, std::string server, int port)
+{
+	ReceiveState state;
+	auto start{ std::chrono::steady_clock::now() };
+	double last_sample{ 0.0 };
+	float send_latency{ 0.0f }; // worst enqueue to send delay (ms) since the last sample
 	while (run)
 	{
-		std::string message;
-		g_msg2server_mutex.lock();
-		if (!g_msg2server_queue.empty()) {
-			message = g_msg2server_queue.front();
-			g_msg2server_queue.pop();
-		}
-		else {
-			g_msg2server_mutex.unlock();
+		Message* message{ g_msg2server_queue.front() };
+		if (!message) {
+			// sleep until the render thread posts a message
+			client.wait(IDLE_TIMEOUT);
 			continue;
 		}
-		g_msg2server_mutex.unlock();
 
 		// processing
-		int code = std::atoi(message.substr(0, message.find_first_of(':')).c_str());
-
-		if (code == 0) {
-			if (client.connect(SERVER, PORT)) {
-				g_msg2client_mutex.lock();
-				g_msg2client_queue.emplace("0:1");
-				g_msg2client_mutex.unlock();
-				g_connected_mutex.lock();
+		if (message->m_code == MESSAGE::CONNECT) {
+			if (client.connect(server, port)) {
+				enqueue_message(g_msg2client_queue, MESSAGE::CONNECTION_RESULT, "1");
 				g_connected = true;
-				g_connected_mutex.unlock();
-				// send nickname and profile picture
-				std::string nn("nn" + message.substr(message.find_first_of(':') + 1, message.find_last_of(':') - 2));
-				std::string pp("pp" + message.substr(message.find_last_of(':') + 1));
-				client.send_data(nn);
-				client.send_data(pp);
+				// send nickname and profile picture (hello packet)
+				client.send_packet(message->m_data.data(), message->m_size);
+				client.flush_batches();
 			}
 			else {
-				g_msg2client_mutex.lock();
-				g_msg2client_queue.emplace("0:0");
-				g_msg2client_mutex.unlock();
+				enqueue_message(g_msg2client_queue, MESSAGE::CONNECTION_RESULT, "0");
 			}
 		}
+		g_msg2server_queue.pop();
 
 		// connected to server
-		while (g_connected)
+		while (run && g_connected)
 		{
-			std::string message;
-			g_msg2server_mutex.lock();
-			if (!g_msg2server_queue.empty()) {
-				message = g_msg2server_queue.front();
+			// send every packet posted since the last service, they are already encoded
+			while ((message = g_msg2server_queue.front()) != nullptr) {
+				if (message->m_code == MESSAGE::PACKET) {
+					client.send_packet(message->m_data.data(), message->m_size);
+					float latency{ std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - message->m_time).count() };
+					send_latency = (latency > send_latency) ? latency : send_latency;
+				}
 				g_msg2server_queue.pop();
-				g_msg2server_mutex.unlock();
-				
-				// processing
-				int code = std::atoi(message.substr(0, message.find_first_of(':')).c_str());
-				switch (code)
-				{
-					case 1:
-						client.send_data("so"); // search opponent
-						break;
-					case 2:
-						client.send_data("sso"); // stop stearch opponent
-						break;
-					case 3:
-						client.send_data("gu"); // give up
-						break;
-					case 4:
-						if (!message.substr(2).empty()) {
-							client.send_data("gc:" + message.substr(2)); // game chat
-						}
-						break;
-					default:
-						break;
-				};
-			}
-			else{
-				g_msg2server_mutex.unlock();
 			}
+			client.flush_batches();
 
-			if (client.service())
+			// send the batches and process every pending event
+			while (client.service() > 0)
 			{
 				if (client.m_event.type == ENET_EVENT_TYPE_RECEIVE)
 				{
-					std::string message(reinterpret_cast<char*>(client.m_event.packet->data));
-					std::string type(message.substr(0, message.find_first_of(':')));
-					if (type == "g0") { // game init
-						g_game_init_mutex.lock();
-						g_game_found = true;
-						g_game_init = message.substr(message.find_first_of(':')+1);
-						g_game_init_mutex.unlock();
-					}
-					else if (type == "gc") { // game chat
-						std::string data = message.substr(message.find_first_of(':') + 1);
-						int messageLength{std::atoi(data.substr(0, data.find_first_of(':')).c_str())};
-						if(messageLength > 0){
-							std::string chatMsg = data.substr(data.find_first_of(':') + 1);
-							if (writer.m_chatLog.size() == 7)
-							{
-								for (int i{ 0 }; i < 6; ++i) {
-									writer.m_chatLog[i] = writer.m_chatLog[i + 1];
-								}
-								writer.m_chatLog[6] = chatMsg;
-							}
-							else {
-								writer.m_chatLog.push_back(chatMsg);
-							}
+					// a packet may hold several protocol packets, sent together in the same frame
+					ENetPacket* packet{ client.m_event.packet };
+					std::size_t offset{ 0 };
+					while (offset < packet->dataLength)
+					{
+						PacketReader reader(packet->data + offset, packet->dataLength - offset);
+						PacketHeader header;
+						if (!reader.read_header(header)) {
+							std::cerr << "Error: malformed packet received from the server.\n";
+							break;
 						}
+						handle_packet(reader, header, state, client);
+						offset += PACKET_HEADER_SIZE + header.size;
 					}
+					enet_packet_destroy(packet);
+				}
+			}
+
+			// telemetry, dropped if the render thread does not consume it (overlay hidden and no CSV)
+			double now{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+			if (now - last_sample >= STATS_INTERVAL)
+			{
+				NetworkSample* sample{ g_stats_queue.acquire() };
+				if (sample)
+				{
+					sample->m_time = now;
+					client.sample_stats(*sample);
+					sample->m_queue_to_server = static_cast<std::uint32_t>(g_msg2server_queue.size());
+					sample->m_queue_to_client = static_cast<std::uint32_t>(g_msg2client_queue.size());
+					sample->m_send_latency = send_latency;
+					g_stats_queue.commit();
 				}
+				last_sample = now;
+				send_latency = 0.0f;
 			}
+
+			// sleep until server traffic, a message from the render thread or the next ENet timer
+			client.wait(SERVICE_TIMEOUT);
 		}
 
 		// disconnect
@@ -127,7 +195,7 @@ void network_thread(bool& run, Writer& writer)
 	}
 }
 
-void render(std::unique_ptr<WindowManager> client, std::unique_ptr<Game> game)
+void render(WindowManager& client, Game& game, NetworkStats& stats)
 {
     // IMGUI data
     EDITOR_UI_SETTINGS editor_settings;
@@ -136,43 +204,130 @@ void render(std::unique_ptr<WindowManager> client, std::unique_ptr<Game> game)
     DRAWING_MODE draw_mode{DRAWING_MODE::SOLID};
     bool debug{false};
     bool debugPhysics{false};
-	game->setActiveScene(0);
+	game.setActiveScene(0);
 
 	// delta
 	double currentFrame{0.0f};
 	double lastFrame{0.0};
 	float delta{0.0f};
 	
-	while(client->isAlive())
+	while(client.isAlive())
 	{
 		currentFrame = omp_get_wtime();
 		delta = static_cast<float>(currentFrame - lastFrame);
-		if (game->getCursorFocus() == 2) {
-			client->checkEvents();
+		if (game.getCursorFocus() == 2) {
+			client.checkEvents();
 		}
         else {
-            client->checkEvents(true);
+            client.checkEvents(true);
         }
-		game->updateUI(client->getUserInputs(), client->get_text_input(), client->getWidth(), client->getHeight(), delta);
-		game->updateSceneActiveCameraView(game->getActiveScene(), client->getUserInputs(), client->getMouseData(), delta);
+		game.updateUI(client.getUserInputs(), client.get_text_input(), client.getWidth(), client.getHeight(), delta);
+		game.updateSceneActiveCameraView(game.getActiveScene(), client.getUserInputs(), client.getMouseData(), delta);
 
 		// draw scene
-		game->draw(delta, currentFrame, client->getWidth(), client->getHeight(), draw_mode, debug, debugPhysics);
+		game.draw(delta, currentFrame, client.getWidth(), client.getHeight(), draw_mode, debug, debugPhysics);
+
+		// network telemetry overlay, toggled with F3
+		stats.poll();
+		stats.add_frame(delta);
+		stats.add_render(game.get_render_stats());
+		if (client.show_stats_overlay())
+		{
+			ImGui_ImplOpenGL3_NewFrame();
+			ImGui_ImplSDL2_NewFrame(client.getWindowPtr());
+			ImGui::NewFrame();
+			stats.draw_overlay();
+			ImGui::Render();
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		}
 
-		client->resetEvents();
-		SDL_GL_SwapWindow(client->getWindowPtr());
+		client.resetEvents();
+		SDL_GL_SwapWindow(client.getWindowPtr());
 		lastFrame = currentFrame;
 	}
 }
 
 int main(int argc, char* argv[])
 {
+	// --server and --port override the game server, e.g. to play against frutibandas_server on localhost
+	// --net-csv streams the network statistics to a file, --net-overlay shows them from the start
+	// --offline plays against the local AI instead of the server, --ai-time sets its thinking time per action
+	// --ai alphabeta|mcts picks the AI, --ai-threads, --ai-playouts and --ai-policy random|moves|greedy tune the MCTS
+	// --replays writes the offline games in a directory, see replay.hpp
+	std::string server{ SERVER };
+	int port{ PORT };
+	std::string stats_csv;
+	bool stats_overlay{ false };
+	bool offline{ false };
+	double ai_time{ AI_THINK_TIME };
+	AI ai{ AI::ALPHA_BETA };
+	MctsOptions mcts;
+	std::string replay_dir;
+	for (int i{ 1 }; i < argc; ++i)
+	{
+		std::string arg{ argv[i] };
+		if (arg == "--net-overlay")
+			stats_overlay = true;
+		else if (arg == "--offline")
+			offline = true;
+		else if (i + 1 == argc)
+		{
+			std::cerr << "Error: no value for the option " << arg << ".\n";
+			return 1;
+		}
+		else if (arg == "--server")
+			server = argv[++i];
+		else if (arg == "--port")
+			port = std::atoi(argv[++i]);
+		else if (arg == "--net-csv")
+			stats_csv = argv[++i];
+		else if (arg == "--ai-time")
+			ai_time = std::atof(argv[++i]);
+		else if (arg == "--ai")
+			ai = (std::string(argv[++i]) == "mcts") ? AI::MCTS : AI::ALPHA_BETA;
+		else if (arg == "--ai-threads")
+			mcts.threads = std::atoi(argv[++i]);
+		else if (arg == "--ai-playouts")
+			mcts.playouts = std::strtoull(argv[++i], nullptr, 10);
+		else if (arg == "--ai-policy")
+		{
+			std::string policy{ argv[++i] };
+			mcts.policy = (policy == "random") ? PLAYOUT_POLICY::RANDOM : ((policy == "moves") ? PLAYOUT_POLICY::MOVES : PLAYOUT_POLICY::GREEDY);
+		}
+		else if (arg == "--replays")
+			replay_dir = argv[++i];
+		else
+		{
+			std::cerr << "Error: unknown option " << arg << ".\n";
+			return 1;
+		}
+	}
+
 	std::unique_ptr<WindowManager> client{std::make_unique<WindowManager>("Frutibandas")};
 	std::unique_ptr<Game> game{std::make_unique<Game>(client->getWidth(), client->getHeight())};
-	// network thread
-	std::thread net_thread(network_thread, std::ref(client->isAlive()), std::ref(game->get_writer()));
+	NetworkClient network;
+	NetworkStats stats;
+	if (!stats_csv.empty())
+		stats.open_csv(stats_csv);
+	client->set_stats_overlay(stats_overlay);
+	// network thread, or the local opponent answering in its place
+	std::thread net_thread;
+	unsigned int seed{ static_cast<unsigned int>(std::chrono::steady_clock::now().time_since_epoch().count()) };
+	mcts.seed = seed;
+	LocalOpponent opponent(ai, ai_time, mcts, seed);
+	opponent.set_replay_dir(replay_dir);
+	if (offline) {
+		net_thread = std::thread(&LocalOpponent::run, &opponent, std::ref(client->isAlive()));
+	}
+	else {
+		game->set_network_client(&network);
+		net_thread = std::thread(network_thread, std::ref(client->isAlive()), std::ref(network), server, port);
+	}
 	// render game
-	render(std::move(client), std::move(game));
+	render(*client, *game, stats);
+	// the window has been closed, wake up the network thread so it can exit
+	network.wake_up();
+	net_thread.join();
 
 	return 0;
 }
@@ -0,0 +1,195 @@
+#include "mcts.hpp"
+#include <cmath>
+#include <limits>
+#include <omp.h>
+
+#define CLOCK_CHECK_PLAYOUTS 64
+
+Mcts::Mcts(const MctsOptions& options) :
+	m_options(options),
+	m_trees(),
+	m_searches(0)
+{}
+
+MctsResult Mcts::search(const GameState& state)
+{
+	MctsResult result{ Action{ ACTION::MOVE, static_cast<std::uint8_t>(DIRECTION::UP), NO_CELL }, 0.0, 0, 0.0, 0.0, 0 };
+	int threads{ (m_options.threads > 0) ? m_options.threads : omp_get_max_threads() };
+	if (static_cast<int>(m_trees.size()) != threads)
+	{
+		m_trees.resize(threads);
+	}
+	result.threads = threads;
+	if (winner(state) != -1)
+		return result;
+
+	std::uint64_t per_thread{ (m_options.playouts > 0) ? (m_options.playouts + threads - 1) / threads : 0 };
+	if (per_thread == 0 && m_options.seconds <= 0.0)
+	{
+		per_thread = 1;
+	}
+	double start{ omp_get_wtime() };
+	double deadline{ start + m_options.seconds };
+	m_searches++;
+
+	#pragma omp parallel num_threads(threads)
+	{
+		int thread{ omp_get_thread_num() };
+		Tree& tree{ m_trees[thread] };
+		tree.rng.seed(static_cast<std::mt19937::result_type>(m_options.seed + m_searches * 7919 + thread * 104729));
+		tree.nodes.clear();
+		tree.nodes.reserve(MCTS_MAX_NODES);
+		tree.nodes.push_back(Node{ Action{}, static_cast<std::uint8_t>(1 - state.m_turn), -1, 0, 0, 0.0f });
+		tree.playouts = 0;
+		while (true)
+		{
+			if (per_thread > 0 && tree.playouts >= per_thread)
+				break;
+			if (m_options.seconds > 0.0 && tree.playouts % CLOCK_CHECK_PLAYOUTS == 0 && omp_get_wtime() >= deadline)
+				break;
+			grow(tree, state);
+			tree.playouts++;
+		}
+	}
+
+	// the root children come from generate_actions in the same order in every tree
+	const Node& root{ m_trees[0].nodes[0] };
+	std::vector<std::uint64_t> visits(root.child_count, 0);
+	std::vector<double> wins(root.child_count, 0.0);
+	for (const Tree& tree : m_trees)
+	{
+		result.playouts += tree.playouts;
+		const Node& tree_root{ tree.nodes[0] };
+		for (int i{ 0 }; i < tree_root.child_count && i < root.child_count; ++i)
+		{
+			visits[i] += tree.nodes[tree_root.first_child + i].visits;
+			wins[i] += tree.nodes[tree_root.first_child + i].wins;
+		}
+	}
+	int best{ -1 };
+	for (int i{ 0 }; i < root.child_count; ++i)
+	{
+		if (best == -1 || visits[i] > visits[best])
+			best = i;
+	}
+	if (best >= 0)
+	{
+		result.action = m_trees[0].nodes[root.first_child + best].action;
+		result.value = (visits[best] > 0) ? wins[best] / visits[best] : 0.5;
+	}
+	result.time = omp_get_wtime() - start;
+	result.playouts_per_second = (result.time > 0.0) ? result.playouts / result.time : 0.0;
+	return result;
+}
+
+void Mcts::grow(Tree& tree, const GameState& root) const
+{
+	std::vector<Node>& nodes{ tree.nodes };
+	GameState state{ root };
+	std::int32_t node{ 0 };
+	tree.path.clear();
+	tree.path.push_back(0);
+
+	// selection : UCT down to a node never visited or not expanded
+	while (nodes[node].first_child >= 0 && nodes[node].child_count > 0)
+	{
+		double log_visits{ std::log(static_cast<double>(nodes[node].visits) + 1.0) };
+		std::int32_t selected{ -1 };
+		double best{ -1.0 };
+		for (std::int32_t i{ 0 }; i < nodes[node].child_count; ++i)
+		{
+			const Node& child{ nodes[nodes[node].first_child + i] };
+			if (child.visits == 0)
+			{
+				selected = nodes[node].first_child + i;
+				break;
+			}
+			double value{ child.wins / child.visits + m_options.exploration * std::sqrt(log_visits / child.visits) };
+			if (value > best)
+			{
+				best = value;
+				selected = nodes[node].first_child + i;
+			}
+		}
+		node = selected;
+		apply_action(state, nodes[node].action);
+		tree.path.push_back(node);
+		if (nodes[node].visits == 0)
+			break;
+	}
+
+	// expansion : every child is created at once, one of them is played
+	if (nodes[node].first_child < 0 && winner(state) == -1 && nodes.size() + MAX_ACTIONS <= MCTS_MAX_NODES)
+	{
+		std::array<Action, MAX_ACTIONS> actions;
+		int count{ generate_actions(state, actions) };
+		std::uint8_t mover{ state.m_turn };
+		nodes[node].first_child = static_cast<std::int32_t>(nodes.size());
+		nodes[node].child_count = count;
+		for (int i{ 0 }; i < count; ++i)
+		{
+			nodes.push_back(Node{ actions[i], mover, -1, 0, 0, 0.0f });
+		}
+		node = nodes[node].first_child + static_cast<std::int32_t>(tree.rng() % count);
+		apply_action(state, nodes[node].action);
+		tree.path.push_back(node);
+	}
+
+	float orange{ playout(state, tree.rng) };
+	for (std::int32_t visited : tree.path)
+	{
+		nodes[visited].visits++;
+		nodes[visited].wins += (nodes[visited].mover == 0) ? orange : 1.0f - orange;
+	}
+}
+
+float Mcts::playout(GameState& state, std::mt19937& rng) const
+{
+	std::array<Action, MAX_ACTIONS> actions;
+	for (int depth{ 0 }; depth < m_options.playout_depth && winner(state) == -1; ++depth)
+	{
+		if (m_options.policy == PLAYOUT_POLICY::RANDOM)
+		{
+			int count{ generate_actions(state, actions) };
+			apply_action(state, actions[rng() % count]);
+			continue;
+		}
+
+		std::uint8_t direction{ static_cast<std::uint8_t>(rng() % 4) };
+		if (m_options.policy == PLAYOUT_POLICY::GREEDY)
+		{
+			// start from a random direction so ties are broken at random
+			int me{ state.m_turn };
+			int best{ std::numeric_limits<int>::min() };
+			std::uint8_t first{ direction };
+			for (std::uint8_t i{ 0 }; i < 4; ++i)
+			{
+				std::uint8_t candidate{ static_cast<std::uint8_t>((first + i) % 4) };
+				GameState next{ state };
+				apply_action(next, Action{ ACTION::MOVE, candidate, NO_CELL });
+				int balance{ popcount(next.m_board.free_fruits(me)) - popcount(next.m_board.free_fruits(1 - me)) };
+				if (balance > best)
+				{
+					best = balance;
+					direction = candidate;
+				}
+			}
+		}
+		apply_action(state, Action{ ACTION::MOVE, direction, NO_CELL });
+	}
+
+	int result{ winner(state) };
+	if (result == 0)
+		return 1.0f;
+	if (result == 1)
+		return 0.0f;
+	if (result == 2)
+		return 0.5f;
+	return evaluate(state);
+}
+
+float Mcts::evaluate(const GameState& state) const
+{
+	int balance{ popcount(state.m_board.free_fruits(0)) - popcount(state.m_board.free_fruits(1)) };
+	return 1.0f / (1.0f + std::exp(-balance / 4.0f));
+}
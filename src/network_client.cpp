@@ -1,9 +1,42 @@
 #include "network_client.hpp"
 
+PacketPool::PacketPool() :
+	m_storage(std::make_unique<std::uint8_t[]>(PACKET_POOL_SIZE * BATCH_CAPACITY))
+{
+	m_free.reserve(PACKET_POOL_SIZE);
+	for (int i{ 0 }; i < PACKET_POOL_SIZE; ++i)
+	{
+		m_free.push_back(m_storage.get() + i * BATCH_CAPACITY);
+	}
+}
+
+std::uint8_t* PacketPool::acquire()
+{
+	if (m_free.empty())
+		return nullptr;
+	std::uint8_t* buffer{ m_free.back() };
+	m_free.pop_back();
+	return buffer;
+}
+
+void PacketPool::release(std::uint8_t* buffer)
+{
+	m_free.push_back(buffer);
+}
+
 NetworkClient::NetworkClient() :
 	m_client(nullptr),
-	m_peer(nullptr)
+	m_peer(nullptr),
+	m_last_received(0),
+	m_last_sent(0),
+	m_wakeup(ENET_SOCKET_NULL)
 {
+	for (auto& batch : m_batch)
+	{
+		batch.m_data = nullptr;
+		batch.m_size = 0;
+	}
+
 	if (enet_initialize() != 0)
 	{
 		throw std::exception("An error occured while initializing ENet !");
@@ -11,17 +44,34 @@ NetworkClient::NetworkClient() :
 	atexit(enet_deinitialize);
 	
 	// create client
-	m_client = enet_host_create(nullptr, 1, 1, 0, 0);
+	m_client = enet_host_create(nullptr, 1, CHANNEL_COUNT, 0, 0);
 	if (m_client == nullptr)
 	{
 		enet_deinitialize();
 		throw std::exception("Error while trying to create the network client !");
 	}
+
+	// create the wake up socket, bound to an ephemeral loopback port
+	m_wakeup = enet_socket_create(ENET_SOCKET_TYPE_DATAGRAM);
+	m_wakeup_address.host = ENET_HOST_TO_NET_32(0x7F000001); // 127.0.0.1
+	m_wakeup_address.port = ENET_PORT_ANY;
+	if (m_wakeup == ENET_SOCKET_NULL ||
+		enet_socket_bind(m_wakeup, &m_wakeup_address) < 0 ||
+		enet_socket_get_address(m_wakeup, &m_wakeup_address) < 0)
+	{
+		enet_host_destroy(m_client);
+		enet_deinitialize();
+		throw std::exception("Error while trying to create the network wake up socket !");
+	}
+	enet_socket_set_option(m_wakeup, ENET_SOCKOPT_NONBLOCK, 1);
 }
 
 NetworkClient::~NetworkClient()
 {
-
+	if (m_wakeup != ENET_SOCKET_NULL)
+	{
+		enet_socket_destroy(m_wakeup);
+	}
 }
 
 bool NetworkClient::connect(std::string server_ip, int port)
@@ -29,7 +79,7 @@ bool NetworkClient::connect(std::string server_ip, int port)
 	enet_address_set_host(&m_address, server_ip.c_str());
 	m_address.port = port;
 
-	m_peer = enet_host_connect(m_client, &m_address, 1, 0);
+	m_peer = enet_host_connect(m_client, &m_address, CHANNEL_COUNT, 0);
 	if (m_peer == nullptr)
 	{
 		enet_host_destroy(m_client);
@@ -82,13 +132,127 @@ void NetworkClient::print_data()
 	std::cout << data << std::endl;
 }
 
-void NetworkClient::send_data(std::string data)
+void NetworkClient::send_packet(const std::uint8_t* data, std::size_t size)
 {
-	ENetPacket* packet = enet_packet_create(data.c_str(), data.size() + 1, ENET_PACKET_FLAG_RELIABLE);
-	enet_peer_send(m_peer, 0, packet);
+	if (size < PACKET_HEADER_SIZE || size > BATCH_CAPACITY || data[1] >= static_cast<std::uint8_t>(PACKET::COUNT))
+	{
+		std::cerr << "Error: invalid packet, not sent.\n";
+		return;
+	}
+	// packets are self delimited by their header, they are simply appended to the batch
+	DELIVERY delivery{ packet_delivery(static_cast<PACKET>(data[1])) };
+	PacketBatch& batch{ m_batch[static_cast<int>(delivery)] };
+	if (batch.m_size + size > BATCH_CAPACITY)
+	{
+		send_batch(delivery);
+	}
+	if (!batch.m_data)
+	{
+		batch.m_data = m_pool.acquire();
+		if (!batch.m_data)
+			batch.m_data = batch.m_fallback.data();
+	}
+	std::memcpy(batch.m_data + batch.m_size, data, size);
+	batch.m_size += size;
+}
+
+void NetworkClient::flush_batches()
+{
+	for (int i{ 0 }; i < CHANNEL_COUNT; ++i)
+	{
+		send_batch(static_cast<DELIVERY>(i));
+	}
+}
+
+void NetworkClient::send_batch(DELIVERY delivery)
+{
+	PacketBatch& batch{ m_batch[static_cast<int>(delivery)] };
+	if (batch.m_size == 0)
+		return;
+
+	// ENet has no reliable unordered mode, chat gets its own reliable channel instead
+	enet_uint32 flags{ ENET_PACKET_FLAG_RELIABLE };
+	ENetPacket* packet;
+	if (batch.m_data == batch.m_fallback.data())
+	{
+		packet = enet_packet_create(batch.m_data, batch.m_size, flags);
+	}
+	else
+	{
+		// no copy, the buffer goes back to the pool once ENet is done with the packet
+		packet = enet_packet_create(batch.m_data, batch.m_size, flags | ENET_PACKET_FLAG_NO_ALLOCATE);
+		if (packet)
+		{
+			packet->freeCallback = release_packet;
+			packet->userData = &m_pool;
+		}
+		else
+		{
+			m_pool.release(batch.m_data);
+		}
+	}
+	if (packet && enet_peer_send(m_peer, static_cast<enet_uint8>(delivery), packet) < 0)
+	{
+		enet_packet_destroy(packet);
+	}
+
+	batch.m_data = nullptr;
+	batch.m_size = 0;
+}
+
+void NetworkClient::release_packet(ENetPacket* packet)
+{
+	static_cast<PacketPool*>(packet->userData)->release(packet->data);
 }
 
 int NetworkClient::service()
 {
 	return enet_host_service(m_client, &m_event, 0);
+}
+
+void NetworkClient::sample_stats(NetworkSample& sample)
+{
+	sample.m_rtt = m_peer->roundTripTime;
+	sample.m_rtt_variance = m_peer->roundTripTimeVariance;
+	sample.m_packet_loss = static_cast<float>(m_peer->packetLoss) / ENET_PEER_PACKET_LOSS_SCALE;
+	// ENet never resets its counters, unsigned arithmetic handles the wrap around
+	sample.m_bytes_in = m_client->totalReceivedData - m_last_received;
+	sample.m_bytes_out = m_client->totalSentData - m_last_sent;
+	m_last_received = m_client->totalReceivedData;
+	m_last_sent = m_client->totalSentData;
+}
+
+bool NetworkClient::wait(enet_uint32 timeout)
+{
+	ENetSocketSet set;
+	ENET_SOCKETSET_EMPTY(set);
+	ENET_SOCKETSET_ADD(set, m_client->socket);
+	ENET_SOCKETSET_ADD(set, m_wakeup);
+	ENetSocket max_socket = (m_client->socket > m_wakeup) ? m_client->socket : m_wakeup;
+
+	if (enet_socketset_select(max_socket, &set, nullptr, timeout) <= 0)
+	{
+		return false;
+	}
+
+	// consume every pending wake up notification
+	if (ENET_SOCKETSET_CHECK(set, m_wakeup))
+	{
+		char byte;
+		ENetBuffer buffer;
+		buffer.data = &byte;
+		buffer.dataLength = 1;
+		while (enet_socket_receive(m_wakeup, nullptr, &buffer, 1) > 0) {}
+	}
+
+	return ENET_SOCKETSET_CHECK(set, m_client->socket);
+}
+
+void NetworkClient::wake_up()
+{
+	char byte{ 0 };
+	ENetBuffer buffer;
+	buffer.data = &byte;
+	buffer.dataLength = 1;
+	enet_socket_send(m_wakeup, &m_wakeup_address, &buffer, 1);
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "network_stats.hpp"
+#include <iostream>
+#include "imgui.h"
+
+NetworkStats::NetworkStats() :
+	m_rtt(500.0f),
+	m_jitter(200.0f),
+	m_loss(100.0f),
+	m_rate_in(64.0f),
+	m_rate_out(64.0f),
+	m_queue_to_server(64.0f),
+	m_queue_to_client(64.0f),
+	m_send_latency(100.0f),
+	m_frame_time(100.0f),
+	m_draw_calls(64.0f),
+	m_atlas_pages(0),
+	m_glyph_pages(0),
+	m_history{},
+	m_history_head(0),
+	m_history_count(0)
+{}
+
+void NetworkStats::poll()
+{
+	NetworkSample* sample;
+	while ((sample = g_stats_queue.front()) != nullptr)
+	{
+		m_rtt.add(static_cast<float>(sample->m_rtt));
+		m_jitter.add(static_cast<float>(sample->m_rtt_variance));
+		m_loss.add(sample->m_packet_loss * 100.0f);
+		m_rate_in.add(sample->m_bytes_in / STATS_INTERVAL / 1024.0f);
+		m_rate_out.add(sample->m_bytes_out / STATS_INTERVAL / 1024.0f);
+		m_queue_to_server.add(static_cast<float>(sample->m_queue_to_server));
+		m_queue_to_client.add(static_cast<float>(sample->m_queue_to_client));
+		m_send_latency.add(sample->m_send_latency);
+
+		m_history[m_history_head] = *sample;
+		m_history_head = (m_history_head + 1) % STATS_WINDOW;
+		m_history_count = (m_history_count < STATS_WINDOW) ? m_history_count + 1 : STATS_WINDOW;
+
+		if (m_csv.is_open())
+		{
+			write_csv_line(m_csv, *sample);
+		}
+		g_stats_queue.pop();
+	}
+}
+
+void NetworkStats::add_frame(float delta)
+{
+	m_frame_time.add(delta * 1000.0f);
+}
+
+void NetworkStats::add_render(const RenderStats& render)
+{
+	m_draw_calls.add(static_cast<float>(render.m_draw_calls));
+	m_atlas_pages = render.m_atlas_pages;
+	m_glyph_pages = render.m_glyph_pages;
+}
+
+bool NetworkStats::open_csv(const std::string& path)
+{
+	m_csv.open(path);
+	if (!m_csv.is_open())
+	{
+		std::cerr << "Error: could not open " << path << " to write the network statistics.\n";
+		return false;
+	}
+	write_csv_header(m_csv);
+	return true;
+}
+
+bool NetworkStats::dump_csv(const std::string& path) const
+{
+	std::ofstream out(path);
+	if (!out.is_open())
+	{
+		std::cerr << "Error: could not open " << path << " to write the network statistics.\n";
+		return false;
+	}
+	write_csv_header(out);
+	std::size_t oldest{ (m_history_head + STATS_WINDOW - m_history_count) % STATS_WINDOW };
+	for (std::size_t i{ 0 }; i < m_history_count; ++i)
+	{
+		write_csv_line(out, m_history[(oldest + i) % STATS_WINDOW]);
+	}
+	return true;
+}
+
+void NetworkStats::write_csv_header(std::ostream& out) const
+{
+	out << "time,rtt_ms,rtt_variance_ms,packet_loss,bytes_in,bytes_out,queue_to_server,queue_to_client,send_latency_ms\n";
+}
+
+void NetworkStats::write_csv_line(std::ostream& out, const NetworkSample& sample) const
+{
+	out << sample.m_time << ","
+		<< sample.m_rtt << ","
+		<< sample.m_rtt_variance << ","
+		<< sample.m_packet_loss << ","
+		<< sample.m_bytes_in << ","
+		<< sample.m_bytes_out << ","
+		<< sample.m_queue_to_server << ","
+		<< sample.m_queue_to_client << ","
+		<< sample.m_send_latency << "\n";
+}
+
+static void draw_histogram(const char* label, const char* unit, const StatsHistogram& histogram)
+{
+	ImGui::Text("%-18s last %7.1f  mean %7.1f  p50 %7.1f  p95 %7.1f  p99 %7.1f %s", label,
+		histogram.last(), histogram.mean(), histogram.percentile(0.5f), histogram.percentile(0.95f), histogram.percentile(0.99f), unit);
+	ImGui::PushID(label);
+	ImGui::PlotLines("", histogram.values(), static_cast<int>(histogram.count()), histogram.offset(),
+		nullptr, 0.0f, histogram.max_value(), ImVec2(0.0f, 40.0f));
+	ImGui::PopID();
+}
+
+void NetworkStats::draw_overlay()
+{
+	ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f), ImGuiCond_FirstUseEver);
+	ImGui::SetNextWindowBgAlpha(0.8f);
+	if (!ImGui::Begin("Network"))
+	{
+		ImGui::End();
+		return;
+	}
+
+	ImGui::Text("server");
+	draw_histogram("round trip time", "ms", m_rtt);
+	draw_histogram("jitter", "ms", m_jitter);
+	draw_histogram("packet loss", "%", m_loss);
+	draw_histogram("download", "KB/s", m_rate_in);
+	draw_histogram("upload", "KB/s", m_rate_out);
+	ImGui::Separator();
+	ImGui::Text("client");
+	draw_histogram("send latency", "ms", m_send_latency);
+	draw_histogram("queue to server", "msg", m_queue_to_server);
+	draw_histogram("queue to client", "msg", m_queue_to_client);
+	draw_histogram("frame time", "ms", m_frame_time);
+	ImGui::Separator();
+	ImGui::Text("renderer");
+	draw_histogram("draw calls", "", m_draw_calls);
+	ImGui::Text("%-18s %d", "atlas pages", m_atlas_pages);
+	ImGui::Text("%-18s %d", "glyph pages", m_glyph_pages);
+	ImGui::Separator();
+	if (ImGui::Button("Dump CSV"))
+	{
+		dump_csv("network_stats.csv");
+	}
+
+	ImGui::End();
+}
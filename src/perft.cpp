@@ -0,0 +1,192 @@
+// headless move generation test of rules.hpp, like the perft of chess engines
+// usage : frutibandas_perft [--depth 4] [--seed 0] [--board <64 cells>] [--orange-cards 0x7] [--banane-cards 0x38]
+//                           [--turn 0] [--divide 0] [--check 0]
+// counts the action sequences of every length up to --depth from the position and prints the nodes and nodes/s
+// of each depth. the position is dealt like the server does with --seed, or given by --board, one character per
+// cell in row major order from the top left, the characters of board_text in rules.hpp
+// --divide 1 prints the nodes under each action of the position at the last depth, to find which one differs
+// --check 1 also checks that every generated action is legal and that the hash of every position is right
+
+#include <iostream>
+#include <string>
+#include <array>
+#include <random>
+#include <chrono>
+#include <cstdlib>
+#include "protocol.hpp"
+#include "rules.hpp"
+
+#define DEFAULT_DEPTH 4
+
+struct PerftOptions
+{
+	int depth{ DEFAULT_DEPTH };
+	unsigned int seed{ 0 };
+	std::string board; // empty => dealt with seed
+	std::uint16_t orange_cards{ 0 };
+	std::uint16_t banane_cards{ 0 };
+	bool cards{ false }; // the hands were given
+	int turn{ 0 };
+	bool divide{ false };
+	bool check{ false };
+};
+
+static std::uint64_t g_errors{ 0 };
+
+static std::uint64_t perft(const GameState& state, int depth, bool check)
+{
+	std::array<Action, MAX_ACTIONS> actions;
+	int count{ generate_actions(state, actions) };
+	if (check)
+	{
+		for (int i{ 0 }; i < count; ++i)
+		{
+			if (!is_legal(state, actions[i]))
+				g_errors++;
+		}
+		if (state.m_hash != compute_hash(state))
+			g_errors++;
+	}
+	// the leaves are counted without being played
+	if (depth == 1 && !check)
+		return count;
+
+	std::uint64_t nodes{ 0 };
+	for (int i{ 0 }; i < count; ++i)
+	{
+		GameState child{ state };
+		apply_action(child, actions[i]);
+		if (depth == 1)
+		{
+			g_errors += (child.m_hash != compute_hash(child)) ? 1 : 0;
+			nodes++;
+		}
+		else
+		{
+			nodes += perft(child, depth - 1, check);
+		}
+	}
+	return nodes;
+}
+
+static bool parse_board(const std::string& text, GameState& state, std::uint16_t orange_cards, std::uint16_t banane_cards)
+{
+	if (text.size() != BOARD_CELLS)
+	{
+		std::cerr << "Error: the board needs " << BOARD_CELLS << " cells, " << text.size() << " given.\n";
+		return false;
+	}
+	std::array<std::uint8_t, BOARD_CELLS> cells;
+	std::array<Bitboard, 2> traps{ 0, 0 };
+	for (int i{ 0 }; i < BOARD_CELLS; ++i)
+	{
+		switch (text[i])
+		{
+			case 'x': cells[i] = 0; break;
+			case '.': cells[i] = CELL_ALIVE; break;
+			case 'o': cells[i] = CELL_ALIVE | 1; break;
+			case 'b': cells[i] = CELL_ALIVE | 2; break;
+			case 'O': cells[i] = CELL_ALIVE | CELL_PETRIFIED | 1; break;
+			case 'B': cells[i] = CELL_ALIVE | CELL_PETRIFIED | 2; break;
+			case '1': cells[i] = CELL_ALIVE | CELL_TRAP; traps[0] |= square(i); break;
+			case '2': cells[i] = CELL_ALIVE | CELL_TRAP; traps[1] |= square(i); break;
+			default:
+				std::cerr << "Error: unknown cell '" << text[i] << "' in the board.\n";
+				return false;
+		}
+	}
+	init_state(state, cells, orange_cards, banane_cards);
+	state.m_trap = traps;
+	state.m_board.m_trap = traps[0] | traps[1];
+	state.m_hash = compute_hash(state);
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	PerftOptions options;
+	for (int i{ 1 }; i + 1 < argc; i += 2)
+	{
+		std::string arg{ argv[i] };
+		if (arg == "--depth")
+			options.depth = std::atoi(argv[i + 1]);
+		else if (arg == "--seed")
+			options.seed = static_cast<unsigned int>(std::atoi(argv[i + 1]));
+		else if (arg == "--board")
+			options.board = argv[i + 1];
+		else if (arg == "--orange-cards")
+		{
+			options.orange_cards = static_cast<std::uint16_t>(std::strtoul(argv[i + 1], nullptr, 0));
+			options.cards = true;
+		}
+		else if (arg == "--banane-cards")
+		{
+			options.banane_cards = static_cast<std::uint16_t>(std::strtoul(argv[i + 1], nullptr, 0));
+			options.cards = true;
+		}
+		else if (arg == "--turn")
+			options.turn = std::atoi(argv[i + 1]) ? 1 : 0;
+		else if (arg == "--divide")
+			options.divide = std::atoi(argv[i + 1]) != 0;
+		else if (arg == "--check")
+			options.check = std::atoi(argv[i + 1]) != 0;
+		else
+		{
+			std::cerr << "Error: unknown option " << arg << ".\n";
+			return 1;
+		}
+	}
+	if (argc % 2 == 0)
+	{
+		std::cerr << "Error: no value for the option " << argv[argc - 1] << ".\n";
+		return 1;
+	}
+
+	GameState state;
+	std::mt19937 rng(options.seed);
+	deal_state(state, rng);
+	if (options.cards)
+	{
+		state.m_cards = { options.orange_cards, options.banane_cards };
+	}
+	if (!options.board.empty() && !parse_board(options.board, state, state.m_cards[0], state.m_cards[1]))
+		return 1;
+	state.m_turn = static_cast<std::uint8_t>(options.turn);
+	state.m_hash = compute_hash(state);
+
+	std::cout << board_text(state);
+	std::cout << "cards orange 0x" << std::hex << state.m_cards[0] << " banane 0x" << state.m_cards[1] << std::dec
+		<< ", " << (state.m_turn ? "banane" : "orange") << " to play, hash " << std::hex << state.m_hash << std::dec << "\n";
+
+	for (int depth{ 1 }; depth <= options.depth; ++depth)
+	{
+		auto start{ std::chrono::steady_clock::now() };
+		std::uint64_t nodes{ perft(state, depth, options.check) };
+		double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+		std::cout << "depth " << depth << " : " << nodes << " nodes in " << seconds << " s ("
+			<< static_cast<std::uint64_t>((seconds > 0.0) ? nodes / seconds : 0.0) << " nodes/s)\n";
+	}
+
+	if (options.divide && options.depth > 1)
+	{
+		std::array<Action, MAX_ACTIONS> actions;
+		int count{ generate_actions(state, actions) };
+		for (int i{ 0 }; i < count; ++i)
+		{
+			GameState child{ state };
+			apply_action(child, actions[i]);
+			if (actions[i].type == ACTION::MOVE)
+				std::cout << "move " << static_cast<int>(actions[i].value);
+			else
+				std::cout << "card " << static_cast<int>(actions[i].value) << " on " << static_cast<int>(actions[i].target);
+			std::cout << " : " << perft(child, options.depth - 1, false) << "\n";
+		}
+	}
+
+	if (options.check)
+	{
+		std::cout << (g_errors ? "FAILED : " : "ok : ") << g_errors << " errors\n";
+		return g_errors ? 1 : 0;
+	}
+	return 0;
+}
@@ -0,0 +1,343 @@
+#include "protocol.hpp"
+#include <cstring>
+
+PacketWriter::PacketWriter(std::uint8_t* buffer, std::size_t capacity) :
+	m_buffer(buffer),
+	m_capacity(capacity),
+	m_size(0),
+	m_start(0),
+	m_overflow(false)
+{}
+
+void PacketWriter::begin(PACKET type)
+{
+	m_start = m_size;
+	write_u8(PROTOCOL_VERSION);
+	write_u8(static_cast<std::uint8_t>(type));
+	write_u16(0); // patched by end()
+}
+
+std::size_t PacketWriter::end()
+{
+	if (m_overflow)
+		return 0;
+	std::size_t payload{ m_size - m_start - PACKET_HEADER_SIZE };
+	if (payload > 0xFFFF)
+		return 0;
+	m_buffer[m_start + 2] = static_cast<std::uint8_t>(payload & 0xFF);
+	m_buffer[m_start + 3] = static_cast<std::uint8_t>(payload >> 8);
+	return m_size - m_start;
+}
+
+void PacketWriter::write_u8(std::uint8_t value)
+{
+	if (m_size + 1 > m_capacity) {
+		m_overflow = true;
+		return;
+	}
+	m_buffer[m_size++] = value;
+}
+
+void PacketWriter::write_u16(std::uint16_t value)
+{
+	write_u8(static_cast<std::uint8_t>(value & 0xFF));
+	write_u8(static_cast<std::uint8_t>(value >> 8));
+}
+
+void PacketWriter::write_u32(std::uint32_t value)
+{
+	write_u16(static_cast<std::uint16_t>(value & 0xFFFF));
+	write_u16(static_cast<std::uint16_t>(value >> 16));
+}
+
+void PacketWriter::write_bytes(const std::uint8_t* data, std::size_t size)
+{
+	if (m_size + size > m_capacity) {
+		m_overflow = true;
+		return;
+	}
+	std::memcpy(m_buffer + m_size, data, size);
+	m_size += size;
+}
+
+void PacketWriter::write_string(std::string_view str)
+{
+	std::size_t size{ (str.size() > 0xFF) ? 0xFF : str.size() };
+	write_u8(static_cast<std::uint8_t>(size));
+	write_bytes(reinterpret_cast<const std::uint8_t*>(str.data()), size);
+}
+
+void PacketWriter::write_avatar(const AvatarData& avatar)
+{
+	write_u8(avatar.gender);
+	write_u8(avatar.hair);
+	write_u8(avatar.eyes);
+	write_u8(avatar.mouth);
+	write_u8(avatar.skin_color);
+	write_u8(avatar.hair_color);
+	write_u8(avatar.eyes_color);
+}
+
+PacketReader::PacketReader(const std::uint8_t* data, std::size_t size) :
+	m_data(data),
+	m_pos(0),
+	m_end(size),
+	m_error(false)
+{}
+
+bool PacketReader::read_header(PacketHeader& header)
+{
+	header.version = read_u8();
+	std::uint8_t type{ read_u8() };
+	header.size = read_u16();
+	if (m_error || header.version != PROTOCOL_VERSION || type >= static_cast<std::uint8_t>(PACKET::COUNT) || header.size > remaining())
+	{
+		m_error = true;
+		return false;
+	}
+	header.type = static_cast<PACKET>(type);
+	// restrict the reader to this packet's payload
+	m_end = m_pos + header.size;
+	return true;
+}
+
+std::uint8_t PacketReader::read_u8()
+{
+	if (m_pos + 1 > m_end) {
+		m_error = true;
+		return 0;
+	}
+	return m_data[m_pos++];
+}
+
+std::uint16_t PacketReader::read_u16()
+{
+	std::uint16_t low{ read_u8() };
+	std::uint16_t high{ read_u8() };
+	return static_cast<std::uint16_t>(low | (high << 8));
+}
+
+std::uint32_t PacketReader::read_u32()
+{
+	std::uint32_t low{ read_u16() };
+	std::uint32_t high{ read_u16() };
+	return low | (high << 16);
+}
+
+const std::uint8_t* PacketReader::read_bytes(std::size_t size)
+{
+	if (m_pos + size > m_end) {
+		m_error = true;
+		return nullptr;
+	}
+	const std::uint8_t* bytes{ m_data + m_pos };
+	m_pos += size;
+	return bytes;
+}
+
+std::string_view PacketReader::read_string()
+{
+	std::size_t size{ read_u8() };
+	const std::uint8_t* bytes{ read_bytes(size) };
+	if (!bytes)
+		return std::string_view();
+	return std::string_view(reinterpret_cast<const char*>(bytes), size);
+}
+
+AvatarData PacketReader::read_avatar()
+{
+	AvatarData avatar;
+	avatar.gender = read_u8();
+	avatar.hair = read_u8();
+	avatar.eyes = read_u8();
+	avatar.mouth = read_u8();
+	avatar.skin_color = read_u8();
+	avatar.hair_color = read_u8();
+	avatar.eyes_color = read_u8();
+	return avatar;
+}
+
+DELIVERY packet_delivery(PACKET type)
+{
+	switch (type)
+	{
+		case PACKET::CHAT:
+		case PACKET::TYPING: // only sent when it changes, a lost or late "stopped" would leave the indicator on
+			return DELIVERY::RELIABLE_UNORDERED;
+		default:
+			return DELIVERY::RELIABLE_ORDERED;
+	}
+}
+
+std::size_t encode_hello(std::uint8_t* buffer, std::size_t capacity, std::string_view nickname, const AvatarData& avatar)
+{
+	PacketWriter writer(buffer, capacity);
+	writer.begin(PACKET::HELLO);
+	writer.write_string(nickname.substr(0, NICKNAME_MAX_SIZE));
+	writer.write_avatar(avatar);
+	return writer.end();
+}
+
+std::size_t encode_command(std::uint8_t* buffer, std::size_t capacity, PACKET type)
+{
+	PacketWriter writer(buffer, capacity);
+	writer.begin(type);
+	return writer.end();
+}
+
+std::size_t encode_move(std::uint8_t* buffer, std::size_t capacity, DIRECTION direction)
+{
+	PacketWriter writer(buffer, capacity);
+	writer.begin(PACKET::MOVE);
+	writer.write_u8(static_cast<std::uint8_t>(direction));
+	return writer.end();
+}
+
+std::size_t encode_card(std::uint8_t* buffer, std::size_t capacity, CARD card, std::uint8_t target)
+{
+	PacketWriter writer(buffer, capacity);
+	writer.begin(PACKET::CARD);
+	writer.write_u8(static_cast<std::uint8_t>(card));
+	writer.write_u8(target);
+	return writer.end();
+}
+
+std::size_t encode_chat(std::uint8_t* buffer, std::size_t capacity, std::string_view text)
+{
+	PacketWriter writer(buffer, capacity);
+	writer.begin(PACKET::CHAT);
+	writer.write_string(text);
+	return writer.end();
+}
+
+std::size_t encode_typing(std::uint8_t* buffer, std::size_t capacity, bool typing)
+{
+	PacketWriter writer(buffer, capacity);
+	writer.begin(PACKET::TYPING);
+	writer.write_u8(typing ? 1 : 0);
+	return writer.end();
+}
+
+void GameSnapshot::set_opponent_name(std::string_view name)
+{
+	opponent_name_size = static_cast<std::uint8_t>((name.size() < NICKNAME_MAX_SIZE) ? name.size() : NICKNAME_MAX_SIZE);
+	std::memcpy(opponent_name_data.data(), name.data(), opponent_name_size);
+}
+
+std::size_t encode_game_init(std::uint8_t* buffer, std::size_t capacity, const GameSnapshot& init, PACKET type)
+{
+	PacketWriter writer(buffer, capacity);
+	writer.begin(type);
+	writer.write_u32(init.sequence);
+	writer.write_u8(init.fruit);
+	writer.write_u8(init.turn);
+	writer.write_u8(init.effects);
+	writer.write_u8(init.pending);
+	writer.write_u8(init.solo);
+	writer.write_u16(init.turn_count);
+	writer.write_u16(init.ack);
+	writer.write_string(init.opponent_name());
+	writer.write_avatar(init.opponent_avatar);
+	writer.write_u16(init.cards);
+	writer.write_bytes(init.board.data(), init.board.size());
+	return writer.end();
+}
+
+std::size_t encode_board_delta(std::uint8_t* buffer, std::size_t capacity, const BoardDelta& delta)
+{
+	PacketWriter writer(buffer, capacity);
+	writer.begin(PACKET::BOARD_DELTA);
+	writer.write_u32(delta.sequence);
+	writer.write_u8(delta.turn);
+	writer.write_u8(delta.effects);
+	writer.write_u8(delta.pending);
+	writer.write_u8(delta.solo);
+	writer.write_u16(delta.turn_count);
+	writer.write_u16(delta.ack);
+	writer.write_u8(delta.direction);
+	writer.write_u8(delta.count);
+	for (int i{ 0 }; i < delta.count; ++i)
+	{
+		writer.write_u8(delta.cells[i].index);
+		writer.write_u8(delta.cells[i].cell);
+	}
+	return writer.end();
+}
+
+bool decode_hello(PacketReader& reader, std::string_view& nickname, AvatarData& avatar)
+{
+	nickname = reader.read_string();
+	avatar = reader.read_avatar();
+	return reader.ok() && nickname.size() <= NICKNAME_MAX_SIZE;
+}
+
+bool decode_move(PacketReader& reader, DIRECTION& direction)
+{
+	std::uint8_t value{ reader.read_u8() };
+	direction = static_cast<DIRECTION>(value);
+	return reader.ok() && value <= static_cast<std::uint8_t>(DIRECTION::LEFT);
+}
+
+bool decode_card(PacketReader& reader, CARD& card, std::uint8_t& target)
+{
+	std::uint8_t value{ reader.read_u8() };
+	card = static_cast<CARD>(value);
+	target = reader.read_u8();
+	return reader.ok() && value < static_cast<std::uint8_t>(CARD::COUNT) && target <= BOARD_CELLS;
+}
+
+bool decode_chat(PacketReader& reader, std::string_view& text)
+{
+	text = reader.read_string();
+	return reader.ok();
+}
+
+bool decode_typing(PacketReader& reader, bool& typing)
+{
+	typing = reader.read_u8() != 0;
+	return reader.ok();
+}
+
+bool decode_game_init(PacketReader& reader, GameSnapshot& init)
+{
+	init.sequence = reader.read_u32();
+	init.fruit = reader.read_u8();
+	init.turn = reader.read_u8();
+	init.effects = reader.read_u8();
+	init.pending = reader.read_u8();
+	init.solo = reader.read_u8();
+	init.turn_count = reader.read_u16();
+	init.ack = reader.read_u16();
+	std::string_view opponent_name{ reader.read_string() };
+	init.opponent_avatar = reader.read_avatar();
+	init.cards = reader.read_u16();
+	const std::uint8_t* board{ reader.read_bytes(init.board.size()) };
+	if (!reader.ok() || opponent_name.size() > NICKNAME_MAX_SIZE || init.fruit > 1 || init.turn > 1 || init.solo > BOARD_CELLS)
+		return false;
+	init.set_opponent_name(opponent_name);
+	std::memcpy(init.board.data(), board, init.board.size());
+	return true;
+}
+
+bool decode_board_delta(PacketReader& reader, BoardDelta& delta)
+{
+	delta.sequence = reader.read_u32();
+	delta.turn = reader.read_u8();
+	delta.effects = reader.read_u8();
+	delta.pending = reader.read_u8();
+	delta.solo = reader.read_u8();
+	delta.turn_count = reader.read_u16();
+	delta.ack = reader.read_u16();
+	delta.direction = reader.read_u8();
+	delta.count = reader.read_u8();
+	if (delta.count > BOARD_CELLS || delta.turn > 1 || delta.solo > BOARD_CELLS || delta.direction > static_cast<std::uint8_t>(DIRECTION::LEFT))
+		return false;
+	for (int i{ 0 }; i < delta.count; ++i)
+	{
+		delta.cells[i].index = reader.read_u8();
+		delta.cells[i].cell = reader.read_u8();
+		if (delta.cells[i].index >= BOARD_CELLS)
+			return false;
+	}
+	return reader.ok();
+}
@@ -0,0 +1,252 @@
+#include "replay.hpp"
+#include <iostream>
+#include <iterator>
+#include <cstring>
+
+#define REPLAY_STATE_SIZE (7 * 8 + 2 * 2 + 4 + 2)
+#define REPLAY_ABANDONED 0xFF
+
+static void write_u64(PacketWriter& writer, std::uint64_t value)
+{
+	writer.write_u32(static_cast<std::uint32_t>(value));
+	writer.write_u32(static_cast<std::uint32_t>(value >> 32));
+}
+
+static std::uint64_t read_u64(PacketReader& reader)
+{
+	std::uint64_t low{ reader.read_u32() };
+	std::uint64_t high{ reader.read_u32() };
+	return low | (high << 32);
+}
+
+static void write_state(PacketWriter& writer, const GameState& state)
+{
+	const BitBoard& board{ state.m_board };
+	write_u64(writer, board.m_alive);
+	write_u64(writer, board.m_orange);
+	write_u64(writer, board.m_banane);
+	write_u64(writer, board.m_petrified);
+	write_u64(writer, board.m_trap);
+	write_u64(writer, state.m_trap[0]);
+	write_u64(writer, state.m_trap[1]);
+	writer.write_u16(state.m_cards[0]);
+	writer.write_u16(state.m_cards[1]);
+	writer.write_u8(state.m_turn);
+	writer.write_u8(state.m_effects);
+	writer.write_u8(state.m_pending);
+	writer.write_u8(state.m_solo);
+	writer.write_u16(state.m_turn_count);
+}
+
+static bool read_state(PacketReader& reader, GameState& state)
+{
+	BitBoard& board{ state.m_board };
+	board.m_alive = read_u64(reader);
+	board.m_orange = read_u64(reader);
+	board.m_banane = read_u64(reader);
+	board.m_petrified = read_u64(reader);
+	board.m_trap = read_u64(reader);
+	state.m_trap[0] = read_u64(reader);
+	state.m_trap[1] = read_u64(reader);
+	state.m_cards[0] = reader.read_u16();
+	state.m_cards[1] = reader.read_u16();
+	state.m_turn = reader.read_u8();
+	state.m_effects = reader.read_u8();
+	state.m_pending = reader.read_u8();
+	state.m_solo = reader.read_u8();
+	state.m_turn_count = reader.read_u16();
+	state.m_hash = compute_hash(state);
+	return reader.ok() && state.m_turn <= 1 && state.m_solo <= NO_CELL;
+}
+
+ReplayWriter::ReplayWriter() :
+	m_file(),
+	m_state{},
+	m_ply(0),
+	m_interval(REPLAY_KEYFRAME_INTERVAL)
+{}
+
+ReplayWriter::~ReplayWriter()
+{
+	close();
+}
+
+bool ReplayWriter::open(const std::string& path, const GameState& state, std::string_view orange, std::string_view banane, int keyframe_interval)
+{
+	close();
+	m_file.open(path, std::ios::binary | std::ios::trunc);
+	if (!m_file)
+	{
+		std::cerr << "Error: could not create the replay " << path << ".\n";
+		return false;
+	}
+	m_state = state;
+	m_ply = 0;
+	m_interval = (keyframe_interval > 0) ? keyframe_interval : REPLAY_KEYFRAME_INTERVAL;
+
+	std::array<std::uint8_t, 2 * NICKNAME_MAX_SIZE + 16> buffer;
+	PacketWriter writer(buffer.data(), buffer.size());
+	writer.write_bytes(reinterpret_cast<const std::uint8_t*>(REPLAY_MAGIC), 4);
+	writer.write_u8(REPLAY_VERSION);
+	writer.write_u16(static_cast<std::uint16_t>(m_interval));
+	writer.write_string(orange.substr(0, NICKNAME_MAX_SIZE));
+	writer.write_string(banane.substr(0, NICKNAME_MAX_SIZE));
+	m_file.write(reinterpret_cast<const char*>(writer.data()), writer.size());
+	keyframe();
+	return true;
+}
+
+void ReplayWriter::keyframe()
+{
+	std::array<std::uint8_t, 1 + 4 + REPLAY_STATE_SIZE> buffer;
+	PacketWriter writer(buffer.data(), buffer.size());
+	writer.write_u8(static_cast<std::uint8_t>(REPLAY_RECORD::KEYFRAME));
+	writer.write_u32(m_ply);
+	write_state(writer, m_state);
+	m_file.write(reinterpret_cast<const char*>(writer.data()), writer.size());
+}
+
+void ReplayWriter::action(const Action& action)
+{
+	if (!is_open())
+		return;
+	std::array<std::uint8_t, 4> record{ static_cast<std::uint8_t>(REPLAY_RECORD::ACTION), static_cast<std::uint8_t>(action.type), action.value, action.target };
+	m_file.write(reinterpret_cast<const char*>(record.data()), record.size());
+	apply_action(m_state, action);
+	m_ply++;
+	if (m_ply % m_interval == 0)
+	{
+		keyframe();
+	}
+}
+
+void ReplayWriter::chat(int fruit, std::string_view text)
+{
+	if (!is_open())
+		return;
+	std::array<std::uint8_t, 2 + 1 + 0xFF> buffer;
+	PacketWriter writer(buffer.data(), buffer.size());
+	writer.write_u8(static_cast<std::uint8_t>(REPLAY_RECORD::CHAT));
+	writer.write_u8(static_cast<std::uint8_t>(fruit));
+	writer.write_string(text);
+	m_file.write(reinterpret_cast<const char*>(writer.data()), writer.size());
+}
+
+void ReplayWriter::close()
+{
+	if (!is_open())
+		return;
+	int result{ winner(m_state) };
+	std::array<std::uint8_t, 2> record{ static_cast<std::uint8_t>(REPLAY_RECORD::END), static_cast<std::uint8_t>((result == -1) ? REPLAY_ABANDONED : result) };
+	m_file.write(reinterpret_cast<const char*>(record.data()), record.size());
+	m_file.close();
+}
+
+Replay::Replay() :
+	m_result(-1),
+	m_interval(REPLAY_KEYFRAME_INTERVAL)
+{}
+
+bool Replay::load(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		std::cerr << "Error: could not open the replay " << path << ".\n";
+		return false;
+	}
+	m_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	m_keyframes.clear();
+	m_actions.clear();
+	m_chats.clear();
+	m_result = -1;
+
+	PacketReader reader(m_data.data(), m_data.size());
+	const std::uint8_t* magic{ reader.read_bytes(4) };
+	std::uint8_t version{ reader.read_u8() };
+	m_interval = reader.read_u16();
+	m_names[0] = std::string(reader.read_string());
+	m_names[1] = std::string(reader.read_string());
+	if (!reader.ok() || std::memcmp(magic, REPLAY_MAGIC, 4) != 0 || version != REPLAY_VERSION || m_interval == 0)
+	{
+		std::cerr << "Error: " << path << " is not a replay of this version.\n";
+		return false;
+	}
+
+	// a record cut by the end of the file is ignored with everything after it
+	// the actions are replayed from the keyframes, seek() only gets legal ones to apply
+	GameState state;
+	while (reader.remaining() > 0)
+	{
+		REPLAY_RECORD tag{ static_cast<REPLAY_RECORD>(reader.read_u8()) };
+		if (tag == REPLAY_RECORD::KEYFRAME)
+		{
+			std::uint32_t ply{ reader.read_u32() };
+			std::size_t offset{ m_data.size() - reader.remaining() };
+			if (!read_state(reader, state) || ply != m_keyframes.size() * m_interval || ply != m_actions.size())
+				break;
+			m_keyframes.push_back(offset);
+		}
+		else if (tag == REPLAY_RECORD::ACTION)
+		{
+			Action action;
+			action.type = static_cast<ACTION>(reader.read_u8());
+			action.value = reader.read_u8();
+			action.target = reader.read_u8();
+			if (!reader.ok())
+				break;
+			if (m_keyframes.empty() || (action.type != ACTION::MOVE && action.type != ACTION::CARD) || action.target > NO_CELL
+				|| !is_legal(state, action))
+			{
+				std::cerr << "Error: illegal action at ply " << plies() << " in the replay " << path << ".\n";
+				return false;
+			}
+			apply_action(state, action);
+			m_actions.push_back(action);
+		}
+		else if (tag == REPLAY_RECORD::CHAT)
+		{
+			std::uint8_t fruit{ reader.read_u8() };
+			std::string_view text{ reader.read_string() };
+			if (!reader.ok())
+				break;
+			m_chats.push_back(ReplayChat{ plies(), fruit, std::string(text) });
+		}
+		else if (tag == REPLAY_RECORD::END)
+		{
+			std::uint8_t result{ reader.read_u8() };
+			m_result = (result == REPLAY_ABANDONED) ? -1 : result;
+			break;
+		}
+		else
+		{
+			std::cerr << "Error: unknown record in the replay " << path << ".\n";
+			break;
+		}
+	}
+	if (m_keyframes.empty())
+	{
+		std::cerr << "Error: the replay " << path << " has no keyframe.\n";
+		return false;
+	}
+	return true;
+}
+
+bool Replay::seek(std::uint32_t ply, GameState& state) const
+{
+	if (ply > plies())
+		return false;
+	std::size_t keyframe{ ply / m_interval };
+	if (keyframe >= m_keyframes.size())
+	{
+		keyframe = m_keyframes.size() - 1;
+	}
+	PacketReader reader(m_data.data() + m_keyframes[keyframe], m_data.size() - m_keyframes[keyframe]);
+	if (!read_state(reader, state))
+		return false;
+	for (std::uint32_t i{ static_cast<std::uint32_t>(keyframe * m_interval) }; i < ply; ++i)
+	{
+		apply_action(state, m_actions[i]);
+	}
+	return true;
+}
@@ -0,0 +1,111 @@
+// headless viewer of the replays written by the server, the offline opponent and the tournament runner
+// usage : frutibandas_replay <file.fbr> [--ply <last>] [--list 0]
+// prints the players and the result of the game, then the board, hands and chat at --ply (number of actions
+// played, cards included). the position is rebuilt from the nearest keyframe, see replay.hpp
+// --list 1 prints every action of the game with its ply
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include "rules.hpp"
+#include "replay.hpp"
+
+static const char* const CARD_NAMES[CARD_COUNT] = {
+	"enclume", "celerite", "confiscation", "renfort", "desordre", "petrification",
+	"vachette", "conversion", "charge", "entracte", "solo", "piege"
+};
+static const char* const DIRECTION_NAMES[4] = { "up", "down", "right", "left" };
+
+static std::string action_text(const Action& action)
+{
+	if (action.type == ACTION::MOVE)
+		return std::string("move ") + DIRECTION_NAMES[action.value & 3];
+	std::string text{ "card " };
+	text += (action.value < CARD_COUNT) ? CARD_NAMES[action.value] : "?";
+	if (action.target != NO_CELL)
+		text += " on " + std::to_string(action.target);
+	return text;
+}
+
+static std::string hand_text(std::uint16_t cards)
+{
+	std::string text;
+	for (int i{ 0 }; i < CARD_COUNT; ++i)
+	{
+		if (!(cards & (1 << i)))
+			continue;
+		text += text.empty() ? "" : ", ";
+		text += CARD_NAMES[i];
+	}
+	return text.empty() ? "-" : text;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "Error: usage : " << argv[0] << " <file.fbr> [--ply N] [--list 0]\n";
+		return 1;
+	}
+	std::string path{ argv[1] };
+	long ply{ -1 };
+	bool list{ false };
+	for (int i{ 2 }; i + 1 < argc; i += 2)
+	{
+		std::string arg{ argv[i] };
+		if (arg == "--ply")
+			ply = std::atol(argv[i + 1]);
+		else if (arg == "--list")
+			list = std::atoi(argv[i + 1]) != 0;
+		else
+		{
+			std::cerr << "Error: unknown option " << arg << ".\n";
+			return 1;
+		}
+	}
+	if (argc % 2 == 1)
+	{
+		std::cerr << "Error: no value for the option " << argv[argc - 1] << ".\n";
+		return 1;
+	}
+
+	Replay replay;
+	if (!replay.load(path))
+		return 1;
+	int result{ replay.result() };
+	std::cout << replay.name(0) << " (orange) vs " << replay.name(1) << " (banane), " << replay.plies() << " plies, "
+		<< ((result == -1) ? "unfinished" : ((result == 2) ? "draw" : ((result == 0) ? "orange wins" : "banane wins")))
+		<< ", keyframe every " << replay.keyframe_interval() << " plies\n";
+
+	if (list)
+	{
+		for (std::uint32_t i{ 0 }; i < replay.plies(); ++i)
+		{
+			std::cout << i << " : " << action_text(replay.action(i)) << "\n";
+		}
+	}
+
+	std::uint32_t target{ (ply < 0 || ply > static_cast<long>(replay.plies())) ? replay.plies() : static_cast<std::uint32_t>(ply) };
+	GameState state;
+	auto start{ std::chrono::steady_clock::now() };
+	if (!replay.seek(target, state))
+	{
+		std::cerr << "Error: could not rebuild ply " << target << ".\n";
+		return 1;
+	}
+	double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+	std::cout << "\nply " << target << " (turn " << state.m_turn_count << ", " << (state.m_turn ? "banane" : "orange")
+		<< " to play), rebuilt in " << seconds * 1e6 << " us\n";
+	std::cout << board_text(state);
+	std::cout << "orange " << state.m_board.count(0) << " : " << hand_text(state.m_cards[0]) << "\n";
+	std::cout << "banane " << state.m_board.count(1) << " : " << hand_text(state.m_cards[1]) << "\n";
+	for (const ReplayChat& chat : replay.chats())
+	{
+		if (chat.ply > target)
+			break;
+		std::cout << "[" << chat.ply << "] " << replay.name(chat.fruit & 1) << " : " << chat.text << "\n";
+	}
+	return 0;
+}
@@ -0,0 +1,538 @@
+#include "rules.hpp"
+#include "zobrist.hpp"
+#include <utility>
+#include <algorithm>
+
+// empty tiles filled by renfort, from the center of the board to its corners (the border falls first)
+static const std::array<std::uint8_t, BOARD_CELLS>& renfort_order()
+{
+	static const std::array<std::uint8_t, BOARD_CELLS> order = []()
+	{
+		std::array<std::uint8_t, BOARD_CELLS> cells;
+		std::array<int, BOARD_CELLS> distance;
+		for (int i{ 0 }; i < BOARD_CELLS; ++i)
+		{
+			int row{ i / 8 }, col{ i % 8 };
+			int dr{ 2 * row - 7 }, dc{ 2 * col - 7 };
+			distance[i] = dr * dr + dc * dc;
+			cells[i] = static_cast<std::uint8_t>(i);
+		}
+		// insertion sort, stable so ties keep the row major order
+		for (int i{ 1 }; i < BOARD_CELLS; ++i)
+		{
+			for (int j{ i }; j > 0 && distance[cells[j]] < distance[cells[j - 1]]; --j)
+			{
+				std::swap(cells[j], cells[j - 1]);
+			}
+		}
+		return cells;
+	}();
+	return order;
+}
+
+// tiles destroyed with what stands on them
+static void remove_cells(GameState& state, Bitboard cells)
+{
+	BitBoard& board{ state.m_board };
+	board.m_alive &= ~cells;
+	board.m_orange &= ~cells;
+	board.m_banane &= ~cells;
+	board.m_petrified &= ~cells;
+	board.m_trap &= ~cells;
+	state.m_trap[0] &= ~cells;
+	state.m_trap[1] &= ~cells;
+}
+
+// the outer ring of the remaining tiles falls
+static void shrink(GameState& state)
+{
+	Bitboard alive{ state.m_board.m_alive };
+	if (alive == 0)
+		return;
+	int top{ 8 }, bottom{ -1 };
+	Bitboard columns{ 0 };
+	for (int row{ 0 }; row < 8; ++row)
+	{
+		Bitboard line{ (alive >> (row * 8)) & 0xFF };
+		if (line == 0)
+			continue;
+		top = (row < top) ? row : top;
+		bottom = row;
+		columns |= line;
+	}
+	int left{ lowest_bit(columns) };
+	int right{ 7 };
+	while (!(columns & (Bitboard(1) << right)))
+	{
+		right--;
+	}
+	Bitboard ring{ (Bitboard(0xFF) << (top * 8)) | (Bitboard(0xFF) << (bottom * 8)) | (COLUMN_LEFT << left) | (COLUMN_LEFT << right) };
+	remove_cells(state, ring);
+}
+
+static std::uint64_t hash_cells(PLANE plane, Bitboard cells)
+{
+	std::uint64_t hash{ 0 };
+	const auto& keys{ g_zobrist.cell[static_cast<int>(plane)] };
+	while (cells)
+	{
+		hash ^= keys[lowest_bit(cells)];
+		cells &= cells - 1;
+	}
+	return hash;
+}
+
+static std::uint64_t hash_bits(const std::array<std::uint64_t, 8>& keys, std::uint8_t bits)
+{
+	std::uint64_t hash{ 0 };
+	for (int i{ 0 }; i < 8; ++i)
+	{
+		if (bits & (1 << i))
+			hash ^= keys[i];
+	}
+	return hash;
+}
+
+static std::uint64_t hash_hand(int fruit, std::uint16_t cards)
+{
+	std::uint64_t hash{ 0 };
+	for (int i{ 0 }; i < CARD_COUNT; ++i)
+	{
+		if (cards & (1 << i))
+			hash ^= g_zobrist.card[fruit][i];
+	}
+	return hash;
+}
+
+// keys of the features present in one state and not in the other : the cost is the number of changes,
+// a move touches a few cells and the turn fields, not the whole board
+static std::uint64_t hash_difference(const GameState& a, const GameState& b)
+{
+	std::uint64_t hash{ 0 };
+	hash ^= hash_cells(PLANE::ALIVE, a.m_board.m_alive ^ b.m_board.m_alive);
+	hash ^= hash_cells(PLANE::ORANGE, a.m_board.m_orange ^ b.m_board.m_orange);
+	hash ^= hash_cells(PLANE::BANANE, a.m_board.m_banane ^ b.m_board.m_banane);
+	hash ^= hash_cells(PLANE::PETRIFIED, a.m_board.m_petrified ^ b.m_board.m_petrified);
+	hash ^= hash_cells(PLANE::TRAP_ORANGE, a.m_trap[0] ^ b.m_trap[0]);
+	hash ^= hash_cells(PLANE::TRAP_BANANE, a.m_trap[1] ^ b.m_trap[1]);
+	if (a.m_cards[0] != b.m_cards[0])
+		hash ^= hash_hand(0, a.m_cards[0] ^ b.m_cards[0]);
+	if (a.m_cards[1] != b.m_cards[1])
+		hash ^= hash_hand(1, a.m_cards[1] ^ b.m_cards[1]);
+	if (a.m_turn != b.m_turn)
+		hash ^= g_zobrist.banane_to_play;
+	hash ^= hash_bits(g_zobrist.effect, a.m_effects ^ b.m_effects);
+	hash ^= hash_bits(g_zobrist.pending, a.m_pending ^ b.m_pending);
+	if (a.m_solo != b.m_solo)
+		hash ^= g_zobrist.solo[a.m_solo] ^ g_zobrist.solo[b.m_solo];
+	int phase_a{ a.m_turn_count % SHRINK_PERIOD }, phase_b{ b.m_turn_count % SHRINK_PERIOD };
+	if (phase_a != phase_b)
+		hash ^= g_zobrist.shrink_phase[phase_a] ^ g_zobrist.shrink_phase[phase_b];
+	return hash;
+}
+
+std::string board_text(const GameState& state)
+{
+	const BitBoard& board{ state.m_board };
+	std::string text;
+	for (int index{ 0 }; index < BOARD_CELLS; ++index)
+	{
+		char c{ board.is_alive(index) ? '.' : 'x' };
+		int fruit{ board.fruit(index) };
+		if (fruit >= 0)
+			c = board.is_petrified(index) ? "OB"[fruit] : "ob"[fruit];
+		else if (state.m_trap[0] & square(index))
+			c = '1';
+		else if (state.m_trap[1] & square(index))
+			c = '2';
+		text += c;
+		if (index % 8 == 7)
+			text += '\n';
+	}
+	return text;
+}
+
+std::uint64_t compute_hash(const GameState& state)
+{
+	std::uint64_t hash{ 0 };
+	hash ^= hash_cells(PLANE::ALIVE, state.m_board.m_alive);
+	hash ^= hash_cells(PLANE::ORANGE, state.m_board.m_orange);
+	hash ^= hash_cells(PLANE::BANANE, state.m_board.m_banane);
+	hash ^= hash_cells(PLANE::PETRIFIED, state.m_board.m_petrified);
+	hash ^= hash_cells(PLANE::TRAP_ORANGE, state.m_trap[0]);
+	hash ^= hash_cells(PLANE::TRAP_BANANE, state.m_trap[1]);
+	hash ^= hash_hand(0, state.m_cards[0]);
+	hash ^= hash_hand(1, state.m_cards[1]);
+	hash ^= state.m_turn ? g_zobrist.banane_to_play : 0;
+	hash ^= hash_bits(g_zobrist.effect, state.m_effects);
+	hash ^= hash_bits(g_zobrist.pending, state.m_pending);
+	hash ^= g_zobrist.solo[state.m_solo];
+	hash ^= g_zobrist.shrink_phase[state.m_turn_count % SHRINK_PERIOD];
+	return hash;
+}
+
+static void end_turn(GameState& state)
+{
+	state.m_turn_count++;
+	if (state.m_turn_count % SHRINK_PERIOD == 0)
+	{
+		shrink(state);
+	}
+	state.m_turn = static_cast<std::uint8_t>(1 - state.m_turn);
+	state.m_effects = state.m_pending;
+	state.m_pending = 0;
+	state.m_solo = NO_CELL;
+}
+
+void init_state(GameState& state, const std::array<std::uint8_t, BOARD_CELLS>& cells, std::uint16_t orange_cards, std::uint16_t banane_cards)
+{
+	state.m_board.set_cells(cells);
+	state.m_board.m_trap = 0;
+	state.m_trap = { 0, 0 };
+	state.m_cards = { orange_cards, banane_cards };
+	state.m_turn = 0;
+	state.m_effects = 0;
+	state.m_pending = 0;
+	state.m_solo = NO_CELL;
+	state.m_turn_count = 0;
+	state.m_hash = compute_hash(state);
+}
+
+void deal_state(GameState& state, std::mt19937& rng)
+{
+	std::array<std::uint8_t, BOARD_CELLS> board;
+	for (int i{ 0 }; i < BOARD_CELLS; ++i)
+	{
+		board[i] = CELL_ALIVE | ((i < BOARD_CELLS / 2) ? 1 : 2);
+	}
+	std::shuffle(board.begin(), board.end(), rng);
+	std::array<std::uint16_t, 2> cards;
+	for (auto& hand : cards)
+	{
+		std::array<int, CARD_COUNT> deck;
+		for (int i{ 0 }; i < CARD_COUNT; ++i)
+			deck[i] = i;
+		std::shuffle(deck.begin(), deck.end(), rng);
+		hand = static_cast<std::uint16_t>((1 << deck[0]) | (1 << deck[1]) | (1 << deck[2]));
+	}
+	init_state(state, board, cards[0], cards[1]);
+}
+
+void load_state(GameState& state, const GameSnapshot& snapshot)
+{
+	int mine{ snapshot.fruit };
+	state.m_board.set_cells(snapshot.board);
+	state.m_trap[mine] = state.m_board.m_trap;
+	state.m_trap[1 - mine] = 0;
+	state.m_cards[mine] = snapshot.cards;
+	state.m_cards[1 - mine] = 0;
+	state.m_turn = snapshot.turn;
+	state.m_effects = snapshot.effects;
+	state.m_pending = snapshot.pending;
+	state.m_solo = snapshot.solo;
+	state.m_turn_count = snapshot.turn_count;
+	state.m_hash = compute_hash(state);
+}
+
+void patch_state(GameState& state, const BoardDelta& delta, int viewer)
+{
+	for (int i{ 0 }; i < delta.count; ++i)
+	{
+		state.m_board.set_cell(delta.cells[i].index, delta.cells[i].cell);
+	}
+	state.m_trap[viewer] = state.m_board.m_trap;
+	state.m_trap[1 - viewer] = 0;
+	state.m_turn = delta.turn;
+	state.m_effects = delta.effects;
+	state.m_pending = delta.pending;
+	state.m_solo = delta.solo;
+	state.m_turn_count = delta.turn_count;
+	state.m_hash = compute_hash(state);
+}
+
+void store_state(const GameState& state, int viewer, GameSnapshot& snapshot)
+{
+	snapshot.fruit = static_cast<std::uint8_t>(viewer);
+	snapshot.turn = state.m_turn;
+	snapshot.effects = state.m_effects;
+	snapshot.pending = state.m_pending;
+	snapshot.solo = state.m_solo;
+	snapshot.turn_count = state.m_turn_count;
+	snapshot.cards = state.m_cards[viewer];
+	visible_cells(state, viewer, snapshot.board);
+}
+
+void restrict_view(GameState& state, int viewer)
+{
+	state.m_trap[1 - viewer] = 0;
+	state.m_board.m_trap = state.m_trap[viewer];
+	state.m_cards[1 - viewer] = 0;
+	state.m_hash = compute_hash(state);
+}
+
+std::uint8_t visible_cell(const GameState& state, int index, int viewer)
+{
+	std::uint8_t cell{ state.m_board.cell(index) };
+	if (!(state.m_trap[viewer] & square(index)))
+	{
+		cell &= ~CELL_TRAP;
+	}
+	return cell;
+}
+
+void visible_cells(const GameState& state, int viewer, std::array<std::uint8_t, BOARD_CELLS>& cells)
+{
+	for (int index{ 0 }; index < BOARD_CELLS; ++index)
+	{
+		cells[index] = visible_cell(state, index, viewer);
+	}
+}
+
+bool card_needs_target(CARD card)
+{
+	switch (card)
+	{
+		case CARD::ENCLUME:
+		case CARD::PETRIFICATION:
+		case CARD::VACHETTE:
+		case CARD::CONVERSION:
+		case CARD::SOLO:
+		case CARD::PIEGE:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// cells the card can target, 0 for cards without target
+static Bitboard card_targets(const GameState& state, CARD card)
+{
+	const BitBoard& board{ state.m_board };
+	int me{ state.m_turn };
+	switch (card)
+	{
+		case CARD::ENCLUME:
+			return board.m_alive;
+		case CARD::PETRIFICATION:
+			return board.free_fruits(0) | board.free_fruits(1);
+		case CARD::VACHETTE:
+			return ~Bitboard(0);
+		case CARD::CONVERSION:
+			return board.free_fruits(1 - me);
+		case CARD::SOLO:
+			return board.free_fruits(me);
+		case CARD::PIEGE:
+			return board.m_alive & ~board.occupied() & ~state.m_trap[me];
+		default:
+			return 0;
+	}
+}
+
+bool is_legal(const GameState& state, const Action& action)
+{
+	if (winner(state) != -1)
+		return false;
+	if (action.type == ACTION::MOVE)
+		return action.value <= static_cast<std::uint8_t>(DIRECTION::LEFT);
+
+	if (action.value >= CARD_COUNT || !(state.m_cards[state.m_turn] & (1 << action.value)))
+		return false;
+	if (state.m_effects & (EFFECT_CARD_PLAYED | EFFECT_MOVED))
+		return false;
+	CARD card{ static_cast<CARD>(action.value) };
+	if (!card_needs_target(card))
+		return true;
+	return action.target < BOARD_CELLS && (card_targets(state, card) & square(action.target));
+}
+
+int generate_actions(const GameState& state, std::array<Action, MAX_ACTIONS>& actions)
+{
+	if (winner(state) != -1)
+		return 0;
+	int count{ 0 };
+	for (std::uint8_t direction{ 0 }; direction <= static_cast<std::uint8_t>(DIRECTION::LEFT); ++direction)
+	{
+		actions[count++] = Action{ ACTION::MOVE, direction, NO_CELL };
+	}
+	if (state.m_effects & (EFFECT_CARD_PLAYED | EFFECT_MOVED))
+		return count;
+
+	std::uint16_t hand{ state.m_cards[state.m_turn] };
+	for (std::uint8_t id{ 0 }; id < CARD_COUNT; ++id)
+	{
+		if (!(hand & (1 << id)))
+			continue;
+		CARD card{ static_cast<CARD>(id) };
+		if (!card_needs_target(card))
+		{
+			actions[count++] = Action{ ACTION::CARD, id, NO_CELL };
+			continue;
+		}
+		// one vachette per column, the cells of the top row stand for their column
+		Bitboard targets{ (card == CARD::VACHETTE) ? Bitboard(0xFF) : card_targets(state, card) };
+		while (targets)
+		{
+			int index{ lowest_bit(targets) };
+			targets &= targets - 1;
+			actions[count++] = Action{ ACTION::CARD, id, static_cast<std::uint8_t>(index) };
+		}
+	}
+	return count;
+}
+
+static void play_card(GameState& state, CARD card, int target)
+{
+	BitBoard& board{ state.m_board };
+	int me{ state.m_turn };
+	Bitboard cell{ (target < BOARD_CELLS) ? square(target) : 0 };
+	switch (card)
+	{
+		case CARD::ENCLUME:
+			remove_cells(state, cell);
+			break;
+		case CARD::CELERITE:
+			state.m_effects |= EFFECT_CELERITE;
+			break;
+		case CARD::CONFISCATION:
+			state.m_pending |= EFFECT_CONFISCATION;
+			break;
+		case CARD::RENFORT:
+		{
+			// only its own traps are skipped, the hidden traps of the opponent would show otherwise
+			Bitboard empty{ board.m_alive & ~board.occupied() & ~state.m_trap[me] };
+			Bitboard landed{ 0 };
+			int placed{ 0 };
+			for (std::uint8_t index : renfort_order())
+			{
+				if (placed == RENFORT_COUNT)
+					break;
+				if (empty & square(index))
+				{
+					landed |= square(index);
+					placed++;
+				}
+			}
+			(me == 0 ? board.m_orange : board.m_banane) |= landed;
+			// a banda landing on a trap of the opponent falls with the tile, like after a move
+			remove_cells(state, landed & state.m_trap[1 - me]);
+			break;
+		}
+		case CARD::DESORDRE:
+			state.m_pending |= EFFECT_DESORDRE;
+			break;
+		case CARD::PETRIFICATION:
+			board.m_petrified |= cell;
+			break;
+		case CARD::VACHETTE:
+		{
+			Bitboard column{ COLUMN_LEFT << (target % 8) };
+			board.m_orange &= ~column;
+			board.m_banane &= ~column;
+			board.m_petrified &= ~column;
+			break;
+		}
+		case CARD::CONVERSION:
+			board.m_orange ^= cell;
+			board.m_banane ^= cell;
+			break;
+		case CARD::CHARGE:
+			state.m_effects |= EFFECT_CHARGE;
+			break;
+		case CARD::ENTRACTE:
+			end_turn(state);
+			break;
+		case CARD::SOLO:
+			state.m_solo = static_cast<std::uint8_t>(target);
+			break;
+		case CARD::PIEGE:
+			state.m_trap[me] |= cell;
+			board.m_trap |= cell;
+			break;
+		default:
+			break;
+	}
+}
+
+static PushResult play_action(GameState& state, const Action& action, MoveSteps* steps)
+{
+	PushResult result{ 0, 0 };
+	if (steps)
+	{
+		steps->count = 0;
+	}
+	if (action.type == ACTION::CARD)
+	{
+		std::uint16_t bit{ static_cast<std::uint16_t>(1 << action.value) };
+		state.m_cards[state.m_turn] &= ~bit;
+		state.m_effects |= EFFECT_CARD_PLAYED;
+		if (state.m_effects & EFFECT_CONFISCATION)
+		{
+			// captured, the card has no effect
+			state.m_cards[1 - state.m_turn] |= bit;
+			return result;
+		}
+		play_card(state, static_cast<CARD>(action.value), action.target);
+		return result;
+	}
+
+	DIRECTION direction{ static_cast<DIRECTION>(action.value) };
+	if (state.m_effects & EFFECT_DESORDRE)
+	{
+		direction = opposite(direction);
+	}
+	BitBoard& board{ state.m_board };
+	bool solo{ state.m_solo != NO_CELL };
+	Bitboard movers{ solo ? square(state.m_solo) : board.free_fruits(state.m_turn) };
+	int step_count{ (state.m_effects & EFFECT_CHARGE) ? 2 : 1 };
+	for (int step{ 0 }; step < step_count; ++step)
+	{
+		PushResult push{ board.push(movers, direction) };
+		// a charge reports its first step
+		if (step == 0)
+		{
+			result = push;
+		}
+		if (steps)
+		{
+			steps->direction = direction;
+			steps->push[steps->count++] = push;
+		}
+		movers = solo ? (shift(movers & push.moved & ~push.killed, direction) | (movers & ~push.moved)) : board.free_fruits(state.m_turn);
+	}
+	// consumed traps
+	state.m_trap[0] &= board.m_trap;
+	state.m_trap[1] &= board.m_trap;
+
+	if ((state.m_effects & EFFECT_CELERITE) && (!solo || movers))
+	{
+		state.m_effects &= ~EFFECT_CELERITE;
+		state.m_effects |= EFFECT_MOVED;
+		state.m_solo = solo ? static_cast<std::uint8_t>(lowest_bit(movers)) : NO_CELL;
+	}
+	else
+	{
+		end_turn(state);
+	}
+	return result;
+}
+
+PushResult apply_action(GameState& state, const Action& action, MoveSteps* steps)
+{
+	GameState before{ state };
+	PushResult result{ play_action(state, action, steps) };
+	state.m_hash ^= hash_difference(before, state);
+	return result;
+}
+
+int winner(const GameState& state)
+{
+	bool orange{ state.m_board.free_fruits(0) != 0 };
+	bool banane{ state.m_board.free_fruits(1) != 0 };
+	if (orange && banane)
+		return -1;
+	if (orange)
+		return 0;
+	if (banane)
+		return 1;
+	return 2;
+}
@@ -0,0 +1,280 @@
+#include "texture_atlas.hpp"
+#include "shader_light.hpp"
+#include "stb_image.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imstb_rectpack.h"
+
+template<typename T>
+static void write_value(std::ofstream& file, T value)
+{
+	file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static T read_value(std::ifstream& file)
+{
+	T value{};
+	file.read(reinterpret_cast<char*>(&value), sizeof(T));
+	return value;
+}
+
+// copies the image at x, y of the page, the padding repeats the border of the image
+static void blit(std::vector<std::uint8_t>& page, int page_width, const std::uint8_t* image, int x, int y, int w, int h)
+{
+	for (int row{ -ATLAS_PADDING }; row < h + ATLAS_PADDING; ++row)
+	{
+		const std::uint8_t* src{ image + std::clamp(row, 0, h - 1) * w * 4 };
+		std::uint8_t* dst{ page.data() + ((y + row) * page_width + x) * 4 };
+		std::memcpy(dst, src, w * 4);
+		for (int i{ 1 }; i <= ATLAS_PADDING; ++i)
+		{
+			std::memcpy(dst - i * 4, src, 4);
+			std::memcpy(dst + (w - 1 + i) * 4, src + (w - 1) * 4, 4);
+		}
+	}
+}
+
+TextureAtlas::TextureAtlas()
+{}
+
+TextureAtlas::~TextureAtlas()
+{
+	if (!m_pages.empty())
+		glDeleteTextures(static_cast<GLsizei>(m_pages.size()), m_pages.data());
+	if (!m_loose.empty())
+		glDeleteTextures(static_cast<GLsizei>(m_loose.size()), m_loose.data());
+}
+
+void TextureAtlas::build(const std::vector<std::string>& directories, const std::string& cache_path)
+{
+	std::vector<AtlasImage> images;
+	for (const std::string& directory : directories)
+	{
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(directory, error))
+		{
+			if (!entry.is_regular_file() || entry.path().extension() != ".tga")
+				continue;
+			AtlasImage image{};
+			image.path = entry.path().generic_string();
+			image.file_size = entry.file_size();
+			image.file_time = static_cast<std::int64_t>(entry.last_write_time().time_since_epoch().count());
+			image.page = -1;
+			images.push_back(image);
+		}
+		if (error)
+			std::cerr << "Error: could not list the images of " << directory << " for the atlas.\n";
+	}
+	std::sort(images.begin(), images.end(), [](const AtlasImage& a, const AtlasImage& b) { return a.path < b.path; });
+
+	GLint max_size;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &max_size);
+	int page_size{ std::min(ATLAS_PAGE_SIZE, static_cast<int>(max_size)) };
+	if (!load_cache(cache_path, images, page_size))
+		pack(images, page_size, cache_path);
+	add_regions(images);
+}
+
+const AtlasRegion& TextureAtlas::get(const std::string& path)
+{
+	auto it{ m_regions.find(path) };
+	if (it != m_regions.end())
+		return it->second;
+	// not packed, on its own texture
+	Texture texture{ createTexture(path, TEXTURE_TYPE::DIFFUSE, true) };
+	m_loose.push_back(texture.id);
+	AtlasRegion region;
+	region.texture = texture.id;
+	return m_regions.emplace(path, region).first->second;
+}
+
+bool TextureAtlas::load_cache(const std::string& cache_path, std::vector<AtlasImage>& images, int page_size)
+{
+	std::ifstream file(cache_path, std::ios::binary);
+	if (!file)
+		return false;
+	char magic[4];
+	file.read(magic, 4);
+	if (!file || std::memcmp(magic, ATLAS_CACHE_MAGIC, 4) != 0 || read_value<std::uint32_t>(file) != ATLAS_CACHE_VERSION
+		|| read_value<std::uint32_t>(file) != static_cast<std::uint32_t>(page_size) || read_value<std::uint32_t>(file) != images.size())
+		return false;
+
+	// the same images, unchanged since the cache was written
+	for (AtlasImage& image : images)
+	{
+		std::string path(read_value<std::uint16_t>(file), '\0');
+		file.read(path.data(), path.size());
+		std::uint64_t file_size{ read_value<std::uint64_t>(file) };
+		std::int64_t file_time{ read_value<std::int64_t>(file) };
+		if (!file || path != image.path || file_size != image.file_size || file_time != image.file_time)
+			return false;
+		image.page = read_value<std::int32_t>(file);
+		image.x = read_value<std::uint16_t>(file);
+		image.y = read_value<std::uint16_t>(file);
+		image.w = read_value<std::uint16_t>(file);
+		image.h = read_value<std::uint16_t>(file);
+	}
+
+	std::uint32_t page_count{ read_value<std::uint32_t>(file) };
+	std::vector<std::uint8_t> texels;
+	for (std::uint32_t i{ 0 }; i < page_count && file; ++i)
+	{
+		std::uint32_t width{ read_value<std::uint32_t>(file) };
+		std::uint32_t height{ read_value<std::uint32_t>(file) };
+		if (width > static_cast<std::uint32_t>(page_size) || height > static_cast<std::uint32_t>(page_size))
+			break;
+		texels.resize(static_cast<std::size_t>(width) * height * 4);
+		file.read(reinterpret_cast<char*>(texels.data()), texels.size());
+		if (file)
+			upload_page(width, height, texels.data());
+	}
+	bool complete{ m_pages.size() == page_count };
+	for (const AtlasImage& image : images)
+	{
+		if (image.page >= static_cast<int>(page_count))
+			complete = false;
+	}
+	if (!complete)
+	{
+		// cut short, packed again
+		glDeleteTextures(static_cast<GLsizei>(m_pages.size()), m_pages.data());
+		m_pages.clear();
+		m_page_size.clear();
+	}
+	return complete;
+}
+
+void TextureAtlas::pack(std::vector<AtlasImage>& images, int page_size, const std::string& cache_path)
+{
+	// bottom row first, like createTexture()
+	stbi_set_flip_vertically_on_load(true);
+	std::vector<std::uint8_t*> texels(images.size(), nullptr);
+	std::vector<stbrp_rect> remaining;
+	for (std::size_t i{ 0 }; i < images.size(); ++i)
+	{
+		AtlasImage& image{ images[i] };
+		int channels;
+		texels[i] = stbi_load(image.path.c_str(), &image.w, &image.h, &channels, 4);
+		image.page = -1;
+		if (!texels[i])
+		{
+			std::cerr << "Error: could not load " << image.path << " in the atlas.\n";
+			image.w = image.h = 0;
+			continue;
+		}
+		int w{ image.w + 2 * ATLAS_PADDING };
+		int h{ image.h + 2 * ATLAS_PADDING };
+		if (w > page_size || h > page_size)
+			continue;
+		stbrp_rect rect{};
+		rect.id = static_cast<int>(i);
+		rect.w = static_cast<stbrp_coord>(w);
+		rect.h = static_cast<stbrp_coord>(h);
+		remaining.push_back(rect);
+	}
+
+	// fill a page with what fits, the rest goes to the next one
+	std::vector<stbrp_node> nodes(page_size);
+	std::vector<std::vector<std::uint8_t>> pages;
+	while (!remaining.empty())
+	{
+		stbrp_context context;
+		stbrp_init_target(&context, page_size, page_size, nodes.data(), page_size);
+		stbrp_pack_rects(&context, remaining.data(), static_cast<int>(remaining.size()));
+		int page{ static_cast<int>(pages.size()) };
+		int height{ 0 };
+		std::vector<stbrp_rect> left;
+		for (const stbrp_rect& rect : remaining)
+		{
+			if (!rect.was_packed)
+			{
+				left.push_back(rect);
+				continue;
+			}
+			AtlasImage& image{ images[rect.id] };
+			image.page = page;
+			image.x = rect.x + ATLAS_PADDING;
+			image.y = rect.y + ATLAS_PADDING;
+			height = std::max(height, rect.y + rect.h);
+		}
+		// only the rows in use are kept
+		pages.emplace_back(static_cast<std::size_t>(page_size) * height * 4, 0);
+		for (std::size_t i{ 0 }; i < images.size(); ++i)
+		{
+			if (images[i].page == page)
+				blit(pages.back(), page_size, texels[i], images[i].x, images[i].y, images[i].w, images[i].h);
+		}
+		upload_page(page_size, height, pages.back().data());
+		remaining.swap(left);
+	}
+	for (std::uint8_t* image : texels)
+	{
+		if (image)
+			stbi_image_free(image);
+	}
+
+	std::ofstream file(cache_path, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		std::cerr << "Error: could not write the atlas cache " << cache_path << ".\n";
+		return;
+	}
+	file.write(ATLAS_CACHE_MAGIC, 4);
+	write_value<std::uint32_t>(file, ATLAS_CACHE_VERSION);
+	write_value<std::uint32_t>(file, page_size);
+	write_value<std::uint32_t>(file, static_cast<std::uint32_t>(images.size()));
+	for (const AtlasImage& image : images)
+	{
+		write_value<std::uint16_t>(file, static_cast<std::uint16_t>(image.path.size()));
+		file.write(image.path.data(), image.path.size());
+		write_value<std::uint64_t>(file, image.file_size);
+		write_value<std::int64_t>(file, image.file_time);
+		write_value<std::int32_t>(file, image.page);
+		write_value<std::uint16_t>(file, static_cast<std::uint16_t>(image.x));
+		write_value<std::uint16_t>(file, static_cast<std::uint16_t>(image.y));
+		write_value<std::uint16_t>(file, static_cast<std::uint16_t>(image.w));
+		write_value<std::uint16_t>(file, static_cast<std::uint16_t>(image.h));
+	}
+	write_value<std::uint32_t>(file, static_cast<std::uint32_t>(pages.size()));
+	for (const std::vector<std::uint8_t>& page : pages)
+	{
+		write_value<std::uint32_t>(file, page_size);
+		write_value<std::uint32_t>(file, static_cast<std::uint32_t>(page.size() / (static_cast<std::size_t>(page_size) * 4)));
+		file.write(reinterpret_cast<const char*>(page.data()), page.size());
+	}
+}
+
+void TextureAtlas::upload_page(int width, int height, const std::uint8_t* texels)
+{
+	GLuint id;
+	glGenTextures(1, &id);
+	glBindTexture(GL_TEXTURE_2D, id);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_SRGB_ALPHA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+	m_pages.push_back(id);
+	m_page_size.emplace_back(width, height);
+}
+
+void TextureAtlas::add_regions(const std::vector<AtlasImage>& images)
+{
+	for (const AtlasImage& image : images)
+	{
+		if (image.page < 0)
+			continue;
+		glm::vec2 size(m_page_size[image.page]);
+		AtlasRegion region;
+		region.texture = m_pages[image.page];
+		region.tex_rect = glm::vec4(image.x / size.x, image.y / size.y, (image.x + image.w) / size.x, (image.y + image.h) / size.y);
+		m_regions[image.path] = region;
+	}
+}
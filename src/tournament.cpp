@@ -0,0 +1,305 @@
+// headless self-play between two bots, no window and no GL context
+// usage : frutibandas_tournament [--games 100] [--threads <cores>] [--a alphabeta] [--b random] [--time 0.05]
+//                                [--playouts 0] [--seed 0] [--replays <directory>]
+// bots : random (any legal action), greedy (the move keeping the best fruit balance), alphabeta, mcts
+// --time is the thinking time per action of the search bots, --playouts replaces it by a fixed budget for mcts
+// the games run concurrently on a pool of --threads threads, the bots swap fruits every game
+// at the end the runner prints the win rates, the average game length, the plies per second and a histogram
+// of the game durations. --replays writes every game in the directory, see replay.hpp
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <array>
+#include <memory>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <cstdlib>
+#include "rules.hpp"
+#include "alpha_beta.hpp"
+#include "mcts.hpp"
+#include "replay.hpp"
+
+#define DEFAULT_GAMES 100
+#define DEFAULT_THINK_TIME 0.05
+#define TOURNAMENT_TABLE_MB 4 // per alpha-beta bot, two per thread
+#define HISTOGRAM_BINS 10
+#define HISTOGRAM_WIDTH 40
+
+enum class BOT
+{
+	RANDOM,
+	GREEDY,
+	ALPHA_BETA,
+	MCTS
+};
+
+static const char* const BOT_NAMES[] = { "random", "greedy", "alphabeta", "mcts" };
+
+struct TournamentOptions
+{
+	int games{ DEFAULT_GAMES };
+	int threads{ 0 }; // 0 => every core
+	std::array<BOT, 2> bots{ BOT::ALPHA_BETA, BOT::RANDOM };
+	double think_time{ DEFAULT_THINK_TIME };
+	std::uint64_t playouts{ 0 };
+	unsigned int seed{ 0 };
+	std::string replay_dir; // empty => no replay
+};
+
+struct GameRecord
+{
+	int winner; // 0 => bot a, 1 => bot b, 2 => draw
+	std::uint32_t plies;
+	double seconds;
+};
+
+// one per bot per thread, the searches keep their tables and trees between the games of the thread
+class Player
+{
+	public:
+		Player(BOT bot, const TournamentOptions& options, unsigned int seed) :
+			m_bot(bot),
+			m_think_time(options.think_time),
+			m_rng(seed),
+			m_alpha_beta(),
+			m_mcts()
+		{
+			if (bot == BOT::ALPHA_BETA)
+			{
+				m_alpha_beta = std::make_unique<AlphaBeta>(TOURNAMENT_TABLE_MB);
+			}
+			else if (bot == BOT::MCTS)
+			{
+				// the games already use every core, one thread per search
+				MctsOptions mcts;
+				mcts.threads = 1;
+				mcts.seconds = (options.playouts > 0) ? 0.0 : options.think_time;
+				mcts.playouts = options.playouts;
+				mcts.seed = seed;
+				m_mcts = std::make_unique<Mcts>(mcts);
+			}
+		}
+
+		// random and greedy choices only depend on the game, not on the games the thread played before
+		void new_game(unsigned int seed)
+		{
+			m_rng.seed(seed);
+		}
+
+		// view only holds what the player to play knows
+		Action play(const GameState& view)
+		{
+			std::array<Action, MAX_ACTIONS> actions;
+			switch (m_bot)
+			{
+				case BOT::ALPHA_BETA:
+					return m_alpha_beta->search(view, m_think_time).action;
+				case BOT::MCTS:
+					return m_mcts->search(view).action;
+				case BOT::GREEDY:
+				{
+					int me{ view.m_turn };
+					int best{ std::numeric_limits<int>::min() };
+					std::uint8_t first{ static_cast<std::uint8_t>(m_rng() % 4) };
+					Action action{ ACTION::MOVE, first, NO_CELL };
+					for (std::uint8_t i{ 0 }; i < 4; ++i)
+					{
+						Action candidate{ ACTION::MOVE, static_cast<std::uint8_t>((first + i) % 4), NO_CELL };
+						GameState next{ view };
+						apply_action(next, candidate);
+						int balance{ popcount(next.m_board.free_fruits(me)) - popcount(next.m_board.free_fruits(1 - me)) };
+						if (balance > best)
+						{
+							best = balance;
+							action = candidate;
+						}
+					}
+					return action;
+				}
+				default:
+				{
+					int count{ generate_actions(view, actions) };
+					return actions[m_rng() % count];
+				}
+			}
+		}
+
+	private:
+		BOT m_bot;
+		double m_think_time;
+		std::mt19937 m_rng;
+		std::unique_ptr<AlphaBeta> m_alpha_beta;
+		std::unique_ptr<Mcts> m_mcts;
+};
+
+static bool parse_bot(const std::string& name, BOT& bot)
+{
+	for (int i{ 0 }; i < 4; ++i)
+	{
+		if (name == BOT_NAMES[i])
+		{
+			bot = static_cast<BOT>(i);
+			return true;
+		}
+	}
+	std::cerr << "Error: unknown bot " << name << ".\n";
+	return false;
+}
+
+static void play_games(const TournamentOptions& options, int thread, std::atomic<int>& next_game, std::vector<GameRecord>& records)
+{
+	// bot a and bot b of this thread
+	std::array<Player, 2> players{ Player(options.bots[0], options, options.seed + thread * 2 + 1), Player(options.bots[1], options, options.seed + thread * 2 + 2) };
+	ReplayWriter replay;
+	int game;
+	while ((game = next_game.fetch_add(1)) < options.games)
+	{
+		auto start{ std::chrono::steady_clock::now() };
+		// the deal and the random and greedy bots only depend on the game number, whatever the thread count
+		// the search bots do not replay : alpha-beta stops on the clock, mcts too unless --playouts is given,
+		// and it mixes the searches it already ran on this thread into its seed
+		std::mt19937 rng(options.seed + static_cast<unsigned int>(game) * 7919);
+		GameState state;
+		deal_state(state, rng);
+		players[0].new_game(rng());
+		players[1].new_game(rng());
+		int a_fruit{ game % 2 };
+		if (!options.replay_dir.empty())
+		{
+			std::string path{ options.replay_dir + "/tournament_" + std::to_string(game) + REPLAY_EXTENSION };
+			std::string a_name{ std::string(BOT_NAMES[static_cast<int>(options.bots[0])]) + " a" };
+			std::string b_name{ std::string(BOT_NAMES[static_cast<int>(options.bots[1])]) + " b" };
+			replay.open(path, state, (a_fruit == 0) ? a_name : b_name, (a_fruit == 0) ? b_name : a_name);
+		}
+
+		std::uint32_t plies{ 0 };
+		while (winner(state) == -1)
+		{
+			GameState view{ state };
+			restrict_view(view, view.m_turn);
+			Player& player{ players[(state.m_turn == a_fruit) ? 0 : 1] };
+			Action action{ player.play(view) };
+			if (!is_legal(state, action))
+			{
+				std::cerr << "Error: illegal action from " << BOT_NAMES[static_cast<int>(options.bots[(state.m_turn == a_fruit) ? 0 : 1])] << ".\n";
+				action = Action{ ACTION::MOVE, static_cast<std::uint8_t>(DIRECTION::UP), NO_CELL };
+			}
+			apply_action(state, action);
+			replay.action(action);
+			plies++;
+		}
+		replay.close();
+
+		int result{ winner(state) };
+		GameRecord& record{ records[game] };
+		record.winner = (result == 2) ? 2 : ((result == a_fruit) ? 0 : 1);
+		record.plies = plies;
+		record.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+static void report(const TournamentOptions& options, const std::vector<GameRecord>& records, double seconds, int threads)
+{
+	std::array<int, 3> wins{ 0, 0, 0 };
+	std::uint64_t plies{ 0 };
+	double longest{ 0.0 };
+	for (const GameRecord& record : records)
+	{
+		wins[record.winner]++;
+		plies += record.plies;
+		longest = std::max(longest, record.seconds);
+	}
+	double games{ static_cast<double>(records.size()) };
+	std::cout << std::fixed << std::setprecision(1);
+	std::cout << records.size() << " games on " << threads << " threads in " << seconds << " s\n";
+	std::cout << BOT_NAMES[static_cast<int>(options.bots[0])] << " a : " << wins[0] << " wins (" << 100.0 * wins[0] / games << " %)\n";
+	std::cout << BOT_NAMES[static_cast<int>(options.bots[1])] << " b : " << wins[1] << " wins (" << 100.0 * wins[1] / games << " %)\n";
+	std::cout << "draws : " << wins[2] << " (" << 100.0 * wins[2] / games << " %)\n";
+	std::cout << "average length : " << plies / games << " plies, " << (seconds > 0.0 ? plies / seconds : 0.0) << " plies/s, "
+		<< (seconds > 0.0 ? games / seconds : 0.0) << " games/s\n";
+
+	// durations of the games, linear bins up to the longest one
+	std::array<int, HISTOGRAM_BINS> bins{};
+	for (const GameRecord& record : records)
+	{
+		int bin{ (longest > 0.0) ? static_cast<int>(record.seconds / longest * HISTOGRAM_BINS) : 0 };
+		bins[std::min(bin, HISTOGRAM_BINS - 1)]++;
+	}
+	int highest{ *std::max_element(bins.begin(), bins.end()) };
+	std::cout << std::setprecision(3) << "game time (ms) :\n";
+	for (int i{ 0 }; i < HISTOGRAM_BINS; ++i)
+	{
+		int width{ (highest > 0) ? bins[i] * HISTOGRAM_WIDTH / highest : 0 };
+		std::cout << std::setw(10) << 1000.0 * longest * i / HISTOGRAM_BINS << " - " << std::setw(10) << 1000.0 * longest * (i + 1) / HISTOGRAM_BINS << " "
+			<< std::string(width, '#') << " " << bins[i] << "\n";
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	TournamentOptions options;
+	for (int i{ 1 }; i + 1 < argc; i += 2)
+	{
+		std::string arg{ argv[i] };
+		if (arg == "--games")
+			options.games = std::atoi(argv[i + 1]);
+		else if (arg == "--threads")
+			options.threads = std::atoi(argv[i + 1]);
+		else if (arg == "--a")
+		{
+			if (!parse_bot(argv[i + 1], options.bots[0]))
+				return 1;
+		}
+		else if (arg == "--b")
+		{
+			if (!parse_bot(argv[i + 1], options.bots[1]))
+				return 1;
+		}
+		else if (arg == "--time")
+			options.think_time = std::atof(argv[i + 1]);
+		else if (arg == "--playouts")
+			options.playouts = std::strtoull(argv[i + 1], nullptr, 10);
+		else if (arg == "--seed")
+			options.seed = static_cast<unsigned int>(std::atoi(argv[i + 1]));
+		else if (arg == "--replays")
+			options.replay_dir = argv[i + 1];
+		else
+		{
+			std::cerr << "Error: unknown option " << arg << ".\n";
+			return 1;
+		}
+	}
+	if (argc % 2 == 0)
+	{
+		std::cerr << "Error: no value for the option " << argv[argc - 1] << ".\n";
+		return 1;
+	}
+	if (options.games <= 0)
+		return 0;
+
+	int threads{ (options.threads > 0) ? options.threads : static_cast<int>(std::thread::hardware_concurrency()) };
+	threads = std::max(1, std::min(threads, options.games));
+	std::vector<GameRecord> records(options.games);
+	std::atomic<int> next_game{ 0 };
+
+	auto start{ std::chrono::steady_clock::now() };
+	std::vector<std::thread> pool;
+	for (int thread{ 0 }; thread < threads; ++thread)
+	{
+		pool.emplace_back(play_games, std::cref(options), thread, std::ref(next_game), std::ref(records));
+	}
+	for (std::thread& thread : pool)
+	{
+		thread.join();
+	}
+	double seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+
+	report(options, records, seconds, threads);
+	return 0;
+}
@@ -0,0 +1,93 @@
+#include "transposition.hpp"
+
+// data word : score 32 bits | depth 8 | bound 2 | generation 6 | has action 1 | action type 1 | value 4 | target 7
+#define GENERATION_MASK 0x3F
+
+TranspositionTable::TranspositionTable(std::size_t megabytes) :
+	m_slots(),
+	m_bucket_count(1),
+	m_generation(0)
+{
+	std::size_t buckets{ megabytes * 1024 * 1024 / (2 * sizeof(Slot)) };
+	while (m_bucket_count * 2 <= buckets)
+	{
+		m_bucket_count *= 2;
+	}
+	m_slots = std::make_unique<Slot[]>(m_bucket_count * 2);
+	clear();
+}
+
+std::uint64_t TranspositionTable::pack(const TTEntry& entry, std::uint8_t generation)
+{
+	std::uint64_t data{ static_cast<std::uint32_t>(entry.score) };
+	data |= static_cast<std::uint64_t>(entry.depth) << 32;
+	data |= static_cast<std::uint64_t>(entry.bound) << 40;
+	data |= static_cast<std::uint64_t>(generation & GENERATION_MASK) << 42;
+	if (entry.has_action)
+	{
+		data |= std::uint64_t(1) << 48;
+		data |= static_cast<std::uint64_t>(entry.action.type) << 49;
+		data |= static_cast<std::uint64_t>(entry.action.value & 0x0F) << 50;
+		data |= static_cast<std::uint64_t>(entry.action.target & 0x7F) << 54;
+	}
+	return data;
+}
+
+TTEntry TranspositionTable::unpack(std::uint64_t data)
+{
+	TTEntry entry;
+	entry.score = static_cast<std::int32_t>(static_cast<std::uint32_t>(data));
+	entry.depth = static_cast<std::uint8_t>(data >> 32);
+	entry.bound = static_cast<BOUND>((data >> 40) & 0x03);
+	entry.has_action = (data >> 48) & 1;
+	entry.action = Action{ static_cast<ACTION>((data >> 49) & 1), static_cast<std::uint8_t>((data >> 50) & 0x0F), static_cast<std::uint8_t>((data >> 54) & 0x7F) };
+	return entry;
+}
+
+bool TranspositionTable::probe(std::uint64_t key, TTEntry& entry) const
+{
+	const Slot* bucket{ &m_slots[(key & (m_bucket_count - 1)) * 2] };
+	for (int i{ 0 }; i < 2; ++i)
+	{
+		std::uint64_t data{ bucket[i].m_data.load(std::memory_order_relaxed) };
+		std::uint64_t check{ bucket[i].m_key.load(std::memory_order_relaxed) };
+		if ((check ^ data) == key && static_cast<BOUND>((data >> 40) & 0x03) != BOUND::NONE)
+		{
+			entry = unpack(data);
+			return true;
+		}
+	}
+	return false;
+}
+
+void TranspositionTable::store(std::uint64_t key, const TTEntry& entry)
+{
+	Slot* bucket{ &m_slots[(key & (m_bucket_count - 1)) * 2] };
+	std::uint8_t generation{ m_generation.load(std::memory_order_relaxed) };
+	std::uint64_t data{ pack(entry, generation) };
+
+	// depth preferred slot : same position, empty, older search or not deeper than the new result
+	std::uint64_t old{ bucket[0].m_data.load(std::memory_order_relaxed) };
+	std::uint64_t old_key{ bucket[0].m_key.load(std::memory_order_relaxed) ^ old };
+	bool replace{ old_key == key
+		|| static_cast<BOUND>((old >> 40) & 0x03) == BOUND::NONE
+		|| ((old >> 42) & GENERATION_MASK) != (generation & GENERATION_MASK)
+		|| static_cast<std::uint8_t>(old >> 32) <= entry.depth };
+	Slot& slot{ replace ? bucket[0] : bucket[1] };
+	slot.m_data.store(data, std::memory_order_relaxed);
+	slot.m_key.store(key ^ data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::new_search()
+{
+	m_generation.store(static_cast<std::uint8_t>((m_generation.load(std::memory_order_relaxed) + 1) & GENERATION_MASK), std::memory_order_relaxed);
+}
+
+void TranspositionTable::clear()
+{
+	for (std::size_t i{ 0 }; i < m_bucket_count * 2; ++i)
+	{
+		m_slots[i].m_key.store(0, std::memory_order_relaxed);
+		m_slots[i].m_data.store(0, std::memory_order_relaxed);
+	}
+}
@@ -1,7 +1,58 @@
 #include "user_interface.hpp"
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+char32_t utf8_decode(const std::string& txt, std::size_t& i)
+{
+    unsigned char lead{ static_cast<unsigned char>(txt[i]) };
+    int length{ (lead < 0x80) ? 1 : ((lead >> 5) == 0x6) ? 2 : ((lead >> 4) == 0xE) ? 3 : ((lead >> 3) == 0x1E) ? 4 : 0 };
+    char32_t code{ (length == 1) ? lead : static_cast<char32_t>(lead & (0x7F >> length)) };
+    for (int k{ 1 }; k < length; ++k)
+    {
+        if (i + k >= txt.size() || (static_cast<unsigned char>(txt[i + k]) & 0xC0) != 0x80)
+        {
+            length = 0;
+            break;
+        }
+        code = (code << 6) | (static_cast<unsigned char>(txt[i + k]) & 0x3F);
+    }
+    // overlong encodings, surrogates and values past U+10FFFF are invalid too
+    static const char32_t smallest[5]{ 0, 0, 0x80, 0x800, 0x10000 };
+    if (length == 0 || code < smallest[length] || (code >= 0xD800 && code <= 0xDFFF) || code > 0x10FFFF)
+    {
+        i++;
+        return 0xFFFD;
+    }
+    i += length;
+    return code;
+}
+
+std::size_t utf8_next(const std::string& txt, std::size_t i)
+{
+    if (i >= txt.size())
+        return txt.size();
+    utf8_decode(txt, i);
+    return i;
+}
+
+std::size_t utf8_previous(const std::string& txt, std::size_t i)
+{
+    // back to the nearest character start whose sequence ends at i
+    std::size_t start{ (i > 4) ? i - 4 : 0 };
+    std::size_t previous{ start };
+    while (start < i)
+    {
+        previous = start;
+        utf8_decode(txt, start);
+    }
+    return previous;
+}
 
 Text::Text(int width, int height) :
     activePoliceIndex(-1),
+    printCount(0),
+    vboCapacity(TEXT_BATCH_GLYPHS * 24),
     shader("shaders/text/vertex.glsl", "shaders/text/fragment.glsl", SHADER_TYPE::TEXT),
     projection(glm::ortho(0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height)))
 {
@@ -20,7 +71,7 @@ void Text::init()
     glGenBuffers(1, &vbo);
     glBindVertexArray(vao);
     glBindBuffer(GL_ARRAY_BUFFER, vbo);
-    glBufferData(GL_ARRAY_BUFFER, 24 * sizeof(float), nullptr, GL_DYNAMIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vboCapacity * sizeof(float), nullptr, GL_STREAM_DRAW);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
     glEnableVertexAttribArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -34,7 +85,11 @@ void Text::resize_screen(int width, int height)
 
 Text::~Text()
 {
+    for (auto& p : police)
+        FT_Done_Face(p.face);
     FT_Done_FreeType(ft);
+    for (auto& page : pages)
+        glDeleteTextures(1, &page.texture);
     glBindVertexArray(vao);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glDeleteBuffers(1, &vbo);
@@ -50,265 +105,430 @@ void Text::load_police(std::string ttf_file, int font_size)
         std::cerr << "ERROR::FREETYPE: Failed loading font" << std::endl;
         std::exit(-1);
     }
-
     FT_Set_Pixel_Sizes(face, 0, font_size);
+
+    // the ASCII glyphs are cached right away, they give the cursor shape
+    police.push_back(Police{ ttf_file, face, {}, {}, 0.0f, 0.0f });
+    Police& font{ police.back() };
+    for (char32_t c{ 0 }; c < 128; ++c)
+    {
+        const Glyph& glyph{ get_glyph(font, c) };
+        font.height = std::max(font.height, static_cast<float>(glyph.size.y));
+        font.descent = std::min(font.descent, static_cast<float>(glyph.bearing.y - glyph.size.y));
+    }
+}
+
+void Text::use_police(int index)
+{
+    activePoliceIndex = index;
+}
+
+const Glyph& Text::get_glyph(Police& font, char32_t code)
+{
+    Glyph& glyph{ (code < 128) ? font.alphabet[code] : font.extended[code] };
+    if (!glyph.loaded || (glyph.page == -1 && glyph.size.x > 0 && glyph.size.y > 0))
+        rasterize(font, code, glyph);
+    if (glyph.page != -1)
+        pages[glyph.page].lastUse = printCount;
+    return glyph;
+}
+
+void Text::rasterize(Police& font, char32_t code, Glyph& glyph)
+{
+    glyph.loaded = true;
+    glyph.page = -1;
+    if(FT_Load_Char(font.face, code, FT_LOAD_RENDER))
+    {
+        std::cerr << "ERROR::FREETYPE: Failed to load glyph : " << static_cast<unsigned long>(code) << std::endl;
+        glyph.size = glm::ivec2(0);
+        glyph.advance = 0;
+        return;
+    }
+    const FT_Bitmap& ft_bitmap{ font.face->glyph->bitmap };
+    glyph.size = glm::ivec2(ft_bitmap.width, ft_bitmap.rows);
+    glyph.bearing = glm::ivec2(font.face->glyph->bitmap_left, font.face->glyph->bitmap_top);
+    glyph.advance = static_cast<int>(font.face->glyph->advance.x);
+    if (glyph.size.x == 0 || glyph.size.y == 0)
+        return;
+
+    glm::ivec2 pos;
+    int page{ allocate(glyph.size.x + GLYPH_PADDING, glyph.size.y + GLYPH_PADDING, pos) };
+    if (page == -1)
+        return;
+    // rows top first, the pitch of FreeType may be larger than the width
+    bitmap.resize(glyph.size.x * glyph.size.y);
+    for (int row{ 0 }; row < glyph.size.y; ++row)
+        std::memcpy(bitmap.data() + row * glyph.size.x, ft_bitmap.buffer + row * ft_bitmap.pitch, glyph.size.x);
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
-    
-    Alphabet alphabet;
-    police.emplace_back(ttf_file, alphabet);
-    
-    for(unsigned char c{0}; c < 128; ++c)
+    glBindTexture(GL_TEXTURE_2D, pages[page].texture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, pos.x, pos.y, glyph.size.x, glyph.size.y, GL_RED, GL_UNSIGNED_BYTE, bitmap.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glyph.tex_rect = glm::vec4(pos.x, pos.y, pos.x + glyph.size.x, pos.y + glyph.size.y) / static_cast<float>(GLYPH_ATLAS_SIZE);
+    glyph.page = page;
+}
+
+// next free texels of the page, on the current shelf or on a new one under it
+static bool place_on_shelf(Text::GlyphPage& page, int w, int h, glm::ivec2& pos)
+{
+    glm::ivec2 shelf{ page.shelf };
+    int shelfHeight{ page.shelfHeight };
+    if (shelf.x + w > GLYPH_ATLAS_SIZE)
     {
-        // load character glyph
-        if(FT_Load_Char(face, c, FT_LOAD_RENDER))
-        {
-            std::cerr << "ERROR::FREETYPE: Failed to load glyph : " << c << std::endl;
-            continue;
-        }
-        // generate texture
-        GLuint texID;
-        glGenTextures(1, &texID);
-        glBindTexture(GL_TEXTURE_2D, texID);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, face->glyph->bitmap.width, face->glyph->bitmap.rows, 0, GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
-        // set texture parameters
+        shelf = glm::ivec2(0, shelf.y + shelfHeight);
+        shelfHeight = 0;
+    }
+    if (shelf.y + h > GLYPH_ATLAS_SIZE)
+        return false;
+    pos = shelf;
+    page.shelf = glm::ivec2(shelf.x + w, shelf.y);
+    page.shelfHeight = std::max(shelfHeight, h);
+    return true;
+}
+
+int Text::allocate(int w, int h, glm::ivec2& pos)
+{
+    if (w > GLYPH_ATLAS_SIZE || h > GLYPH_ATLAS_SIZE)
+        return -1;
+    for (std::size_t i{ 0 }; i < pages.size(); ++i)
+    {
+        if (place_on_shelf(pages[i], w, h, pos))
+            return static_cast<int>(i);
+    }
+
+    int index;
+    if (pages.size() < GLYPH_ATLAS_PAGES)
+    {
+        // new empty page
+        std::vector<unsigned char> texels(GLYPH_ATLAS_SIZE * GLYPH_ATLAS_SIZE, 0);
+        GlyphPage page{ 0, glm::ivec2(0), 0, printCount };
+        glGenTextures(1, &page.texture);
+        glBindTexture(GL_TEXTURE_2D, page.texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE, 0, GL_RED, GL_UNSIGNED_BYTE, texels.data());
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        // store character
-        Glyph character = {
-            texID,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            face->glyph->advance.x
-        };
-        police[police.size()-1].second.insert(std::pair<char, Glyph>(c, character));
+        glBindTexture(GL_TEXTURE_2D, 0);
+        index = static_cast<int>(pages.size());
+        pages.push_back(page);
     }
-
-    // clean up
-    FT_Done_Face(face);
+    else
+    {
+        // every page is full, the least recently drawn one is emptied unless the current string uses it
+        auto oldest{ std::min_element(pages.begin(), pages.end(), [](const GlyphPage& a, const GlyphPage& b) { return a.lastUse < b.lastUse; }) };
+        if (oldest->lastUse == printCount)
+            return -1;
+        index = static_cast<int>(oldest - pages.begin());
+        evict(index);
+    }
+    place_on_shelf(pages[index], w, h, pos);
+    return index;
 }
 
-void Text::use_police(int index)
+void Text::evict(int index)
 {
-    activePoliceIndex = index;
+    for (Police& font : police)
+    {
+        // ASCII metrics stay, their texels come back on their next print
+        for (Glyph& glyph : font.alphabet)
+        {
+            if (glyph.page == index)
+                glyph.page = -1;
+        }
+        for (auto it{ font.extended.begin() }; it != font.extended.end();)
+        {
+            if (it->second.page == index)
+                it = font.extended.erase(it);
+            else
+                ++it;
+        }
+    }
+    GlyphPage& page{ pages[index] };
+    std::vector<unsigned char> texels(GLYPH_ATLAS_SIZE * GLYPH_ATLAS_SIZE, 0);
+    glBindTexture(GL_TEXTURE_2D, page.texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GLYPH_ATLAS_SIZE, GLYPH_ATLAS_SIZE, GL_RED, GL_UNSIGNED_BYTE, texels.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+    page.shelf = glm::ivec2(0);
+    page.shelfHeight = 0;
 }
 
 void Text::print(std::string txt, float x, float y, float scale, glm::vec3 color)
 {
     if (activePoliceIndex == -1)
         return;
-    Alphabet alphabet = police[activePoliceIndex].second;
+    Police& font{ police[activePoliceIndex] };
+    printCount++;
+    if (font.extended.size() > GLYPH_CACHE_SIZE)
+    {
+        // blank and evicted glyphs, the others are bounded by the pages
+        for (auto it{ font.extended.begin() }; it != font.extended.end();)
+        {
+            if (it->second.page == -1)
+                it = font.extended.erase(it);
+            else
+                ++it;
+        }
+    }
+    const TextLayout& layout{ get_layout(txt, scale) };
+
+    // glyphs of the string, the pages they are in are not emptied until the next print
+    glyphs.clear();
+    for (std::size_t i{ 0 }; i < txt.size();)
+        glyphs.push_back(&get_glyph(font, utf8_decode(txt, i)));
+
+    // quads of every character sorted by page, then a single upload and one draw call per page
+    vertices.clear();
+    std::array<std::pair<std::size_t, std::size_t>, GLYPH_ATLAS_PAGES> ranges{}; // first vertex and vertex count
+    for (int page{ 0 }; page < static_cast<int>(pages.size()); ++page)
+    {
+        ranges[page].first = vertices.size() / 4;
+        for (std::size_t i{ 0 }; i < glyphs.size(); ++i)
+        {
+            const Glyph& glyph{ *glyphs[i] };
+            if (glyph.page != page)
+                continue;
+            float xpos = x + layout.pen[i] + glyph.bearing.x * scale;
+            float ypos = y - (glyph.size.y - glyph.bearing.y) * scale;
+
+            float w = glyph.size.x * scale;
+            float h = glyph.size.y * scale;
+            const glm::vec4& uv{ glyph.tex_rect };
+            vertices.insert(vertices.end(), {
+                xpos, ypos + h, uv.x, uv.y,
+                xpos, ypos, uv.x, uv.w,
+                xpos + w, ypos, uv.z, uv.w,
+                xpos, ypos + h, uv.x, uv.y,
+                xpos + w, ypos, uv.z, uv.w,
+                xpos + w, ypos + h, uv.z, uv.y
+            });
+        }
+        ranges[page].second = vertices.size() / 4 - ranges[page].first;
+    }
+    if (vertices.empty())
+        return;
+
+    // update VBO, the storage still used by the previous string is orphaned
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    if (vertices.size() > vboCapacity)
+    {
+        vboCapacity = vertices.capacity();
+        glBufferData(GL_ARRAY_BUFFER, vboCapacity * sizeof(float), vertices.data(), GL_STREAM_DRAW);
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, vboCapacity * sizeof(float), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(float), vertices.data());
+    }
 
     shader.use();
     shader.setVec3f("textColor", color);
     shader.setMatrix("proj", projection);
-    glBindVertexArray(vao);
-
-    // iterate through all characters
-    std::string::const_iterator c;
-    for (c = txt.begin(); c != txt.end(); ++c)
+    glActiveTexture(GL_TEXTURE0);
+    shader.setInt("text", 0);
+    for (std::size_t page{ 0 }; page < pages.size(); ++page)
     {
-        Glyph glyph = alphabet[*c];
-        float xpos = x + glyph.bearing.x * scale;
-        float ypos = y - (glyph.size.y - glyph.bearing.y) * scale;
-
-        float w = glyph.size.x * scale;
-        float h = glyph.size.y * scale;
-
-        // update VBO
-        float vertices[24] = {
-            xpos, ypos + h, 0.0f, 0.0f,
-            xpos, ypos, 0.0f, 1.0f,
-            xpos + w, ypos, 1.0f, 1.0f,
-            xpos, ypos + h, 0.0f, 0.0f,
-            xpos + w, ypos, 1.0f, 1.0f,
-            xpos + w, ypos + h, 1.0f, 0.0f
-        };
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-
-        // bind texture
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, glyph.textureID);
-        shader.setInt("text", 0);
-
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
-
-        // advance cursors for next glyph
-        x += (glyph.advance >> 6) * scale;
+        if (ranges[page].second == 0)
+            continue;
+        glBindTexture(GL_TEXTURE_2D, pages[page].texture);
+        glDrawArrays(GL_TRIANGLES, static_cast<GLint>(ranges[page].first), static_cast<GLsizei>(ranges[page].second));
     }
 
     glBindVertexArray(0);
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
-glm::vec3 Text::get_cursor_shape(std::string txt, float x, float y, float scale, int cursor_pos) // x,y => pos, z => height
+glm::vec3 Text::get_cursor_shape(const std::string& txt, float x, float y, float scale, int cursor_pos) // x,y => pos, z => height
 {
     if (activePoliceIndex == -1)
         throw std::runtime_error("TEXT ERROR : WRONG POLICE INDEX SUPPLIED ! (-1)");
-    Alphabet alphabet = police[activePoliceIndex].second;
+    const Police& font{ police[activePoliceIndex] };
+    const TextLayout& layout{ get_layout(txt, scale) };
+    // character starting at or after the byte cursor_pos
+    std::size_t index{ static_cast<std::size_t>(std::lower_bound(layout.offset.begin(), layout.offset.end(), cursor_pos) - layout.offset.begin()) };
+    return glm::vec3(x + layout.pen[std::min(index, layout.pen.size() - 1)], y + font.descent, font.height);
+}
 
-    // get max glyph vertical size
-    float height = 0.0f;
-    // get vertical shift
-    float yshift = 0.0f;
-    for (unsigned char c{ 0 }; c < 128; ++c)
-    {
-        Glyph glyph = alphabet[c];
-        if (glyph.size.y > height) {
-            height = glyph.size.y;
-        }
-        if ((glyph.bearing.y - glyph.size.y) < yshift) {
-            yshift = (glyph.bearing.y - glyph.size.y);
-        }
-    }
+int Text::get_cursor_pos(const std::string& txt, float x, float scale, float mouseX)
+{
+    if (activePoliceIndex == -1)
+        return 0;
+    // the pen positions grow along the string, the nearest one is next to the first one past the mouse
+    const TextLayout& layout{ get_layout(txt, scale) };
+    const std::vector<float>& pen{ layout.pen };
+    auto after{ std::lower_bound(pen.begin(), pen.end(), mouseX - x) };
+    if (after == pen.end())
+        return static_cast<int>(txt.size());
+    if (after != pen.begin() && (mouseX - x) - *(after - 1) < *after - (mouseX - x))
+        --after;
+    return layout.offset[after - pen.begin()];
+}
 
-    // iterate through "cursor_pos" characters
-    std::string::const_iterator c;
-    for (c = txt.begin(); c < txt.begin() + cursor_pos; ++c)
+const TextLayout& Text::get_layout(const std::string& txt, float scale)
+{
+    LayoutKey key{ txt, activePoliceIndex, scale };
+    auto it{ layouts.find(key) };
+    if (it != layouts.end())
+        return it->second;
+    if (layouts.size() >= TEXT_LAYOUT_CACHE_SIZE)
+        layouts.clear();
+
+    Police& font{ police[activePoliceIndex] };
+    TextLayout layout;
+    float x{ 0.0f };
+    for (std::size_t i{ 0 }; i < txt.size();)
     {
-        Glyph glyph = alphabet[*c];
-        // advance cursors for next glyph
-        x += (glyph.advance >> 6) * scale;
+        layout.pen.push_back(x);
+        layout.offset.push_back(static_cast<int>(i));
+        x += (get_glyph(font, utf8_decode(txt, i)).advance >> 6) * scale;
     }
-    return glm::vec3(x, y + yshift, height);
+    layout.pen.push_back(x);
+    layout.offset.push_back(static_cast<int>(txt.size()));
+    return layouts.emplace(std::move(key), std::move(layout)).first->second;
 }
 
-Sprite::Sprite(int id, glm::vec2 pos, glm::vec2 size, int screenW, int screenH) :
-    m_id(id),
-    m_layer_id(-1),
-    m_pos(pos),
-    m_size(size),
-    m_color(0.0f, 0.0f, 0.0f, 1.0f),
-    m_img_index(-1),
-    m_img_gl(-1),
-    m_bloom_strength(1.0f),
+SpriteBatch::SpriteBatch(int screenW, int screenH) :
+    m_texture(0),
+    m_capacity(SPRITE_BATCH_QUADS * 6),
+    m_draw_calls(0),
     m_shader("shaders/UI/vertex.glsl", "shaders/UI/fragment.glsl", SHADER_TYPE::UI),
-    m_projection(glm::ortho(0.0f, static_cast<float>(screenW), 0.0f, static_cast<float>(screenH))),
-    m_selectable(true),
-    m_selected(false)
+    m_projection(glm::ortho(0.0f, static_cast<float>(screenW), 0.0f, static_cast<float>(screenH)))
 {
+    m_vertices.reserve(m_capacity);
+
     glGenVertexArrays(1, &m_vao);
     glGenBuffers(1, &m_vbo);
 
     glBindVertexArray(m_vao);
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-
-    float data[24] = {
-        m_pos.x, m_pos.y + m_size.y, 0.0f, 1.0f,
-        m_pos.x, m_pos.y, 0.0f, 0.0f,
-        m_pos.x + m_size.x, m_pos.y, 1.0f, 0.0f,
-        m_pos.x, m_pos.y + m_size.y, 0.0f, 1.0f,
-        m_pos.x + m_size.x, m_pos.y, 1.0f, 0.0f,
-        m_pos.x + m_size.x, m_pos.y + m_size.y, 1.0f, 1.0f
-    };
-
-    glBufferData(GL_ARRAY_BUFFER, sizeof(data), data, GL_STATIC_DRAW);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(0));
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, pos));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, tex_coords));
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, color));
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(SpriteVertex), (void*)offsetof(SpriteVertex, bloom_strength));
     glEnableVertexAttribArray(0);
     glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    glEnableVertexAttribArray(3);
     glBindVertexArray(0);
+
+    m_shader.use();
+    m_shader.setInt("image", 0);
 }
 
-Sprite::~Sprite()
+SpriteBatch::~SpriteBatch()
 {
     glBindVertexArray(m_vao);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glDeleteBuffers(1, &m_vbo);
     glBindVertexArray(0);
     glDeleteVertexArrays(1, &m_vao);
-    for (auto& tex : m_img)
-    {
-        if (tex.id != -1)
-            glDeleteTextures(1, &tex.id);
-    }
 }
 
-void Sprite::translate(glm::vec2 shift)
+void SpriteBatch::resize_screen(int width, int height)
 {
-    m_pos += shift;
-    float data[24] = {
-        m_pos.x, m_pos.y, 0.0f, 1.0f,
-        m_pos.x, m_pos.y - m_size.y, 0.0f, 0.0f,
-        m_pos.x + m_size.x, m_pos.y - m_size.y, 1.0f, 0.0f,
-        m_pos.x, m_pos.y, 0.0f, 1.0f,
-        m_pos.x + m_size.x, m_pos.y - m_size.y, 1.0f, 0.0f,
-        m_pos.x + m_size.x, m_pos.y, 1.0f, 1.0f
-    };
+    m_projection = glm::ortho(0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height));
+}
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, 24 * sizeof(float), data);
+void SpriteBatch::add_quad(glm::vec4 rect, glm::vec4 tex_rect, GLuint texture, glm::vec4 color, float bloom_strength)
+{
+    // one texture per draw call, plain color quads do not sample it
+    if (texture != 0)
+    {
+        if (m_texture != 0 && m_texture != texture)
+            flush();
+        m_texture = texture;
+    }
+    float textured{ (texture != 0) ? 1.0f : 0.0f };
+    SpriteVertex bottom_left{ glm::vec2(rect.x, rect.y), glm::vec2(tex_rect.x, tex_rect.y), color, bloom_strength, textured };
+    SpriteVertex bottom_right{ glm::vec2(rect.z, rect.y), glm::vec2(tex_rect.z, tex_rect.y), color, bloom_strength, textured };
+    SpriteVertex top_left{ glm::vec2(rect.x, rect.w), glm::vec2(tex_rect.x, tex_rect.w), color, bloom_strength, textured };
+    SpriteVertex top_right{ glm::vec2(rect.z, rect.w), glm::vec2(tex_rect.z, tex_rect.w), color, bloom_strength, textured };
+    m_vertices.push_back(top_left);
+    m_vertices.push_back(bottom_left);
+    m_vertices.push_back(bottom_right);
+    m_vertices.push_back(top_left);
+    m_vertices.push_back(bottom_right);
+    m_vertices.push_back(top_right);
 }
 
-void Sprite::set_pos(glm::vec2 pos)
+void SpriteBatch::flush()
 {
-    m_pos = pos;
-    float data[24] = {
-        m_pos.x, m_pos.y, 0.0f, 1.0f,
-        m_pos.x, m_pos.y - m_size.y, 0.0f, 0.0f,
-        m_pos.x + m_size.x, m_pos.y - m_size.y, 1.0f, 0.0f,
-        m_pos.x, m_pos.y, 0.0f, 1.0f,
-        m_pos.x + m_size.x, m_pos.y - m_size.y, 1.0f, 0.0f,
-        m_pos.x + m_size.x, m_pos.y, 1.0f, 1.0f
-    };
+    if (m_vertices.empty())
+        return;
 
+    glBindVertexArray(m_vao);
     glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, 24 * sizeof(float), data);
+    if (m_vertices.size() > m_capacity)
+    {
+        m_capacity = m_vertices.capacity();
+        glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(SpriteVertex), m_vertices.data(), GL_STREAM_DRAW);
+    }
+    else
+    {
+        // orphan the storage still read by the previous draw calls instead of waiting for them
+        glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(SpriteVertex), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, m_vertices.size() * sizeof(SpriteVertex), m_vertices.data());
+    }
+
+    m_shader.use();
+    m_shader.setMatrix("proj", m_projection);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m_vertices.size()));
+    glBindVertexArray(0);
+    m_draw_calls++;
+
+    m_vertices.clear();
+    m_texture = 0;
 }
 
-void Sprite::set_size(glm::vec2 size)
-{
-    m_size = size;
-    float data[24] = {
-        m_pos.x, m_pos.y, 0.0f, 1.0f,
-        m_pos.x, m_pos.y - m_size.y, 0.0f, 0.0f,
-        m_pos.x + m_size.x, m_pos.y - m_size.y, 1.0f, 0.0f,
-        m_pos.x, m_pos.y, 0.0f, 1.0f,
-        m_pos.x + m_size.x, m_pos.y - m_size.y, 1.0f, 0.0f,
-        m_pos.x + m_size.x, m_pos.y, 1.0f, 1.0f
-    };
+Sprite::Sprite(int id, glm::vec2 pos, glm::vec2 size) :
+    m_id(id),
+    m_layer_id(-1),
+    m_pos(pos),
+    m_size(size),
+    m_quad(pos.x, pos.y, pos.x + size.x, pos.y + size.y),
+    m_color(0.0f, 0.0f, 0.0f, 1.0f),
+    m_img_index(-1),
+    m_img_gl{},
+    m_bloom_strength(1.0f),
+    m_opacity(1.0f),
+    m_selectable(true),
+    m_selected(false)
+{}
 
-    glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, 24 * sizeof(float), data);
+// once moved or resized, m_pos is the top left corner of the quad
+void Sprite::translate(glm::vec2 shift)
+{
+    m_pos += shift;
+    m_quad = glm::vec4(m_pos.x, m_pos.y - m_size.y, m_pos.x + m_size.x, m_pos.y);
 }
 
-void Sprite::set_background_img(std::string img)
+void Sprite::set_pos(glm::vec2 pos)
 {
-    if (m_img[0].id != -1)
-        glDeleteTextures(1, &m_img[0].id);
-    m_img[0] = createTexture(img, TEXTURE_TYPE::DIFFUSE, true);
+    m_pos = pos;
+    m_quad = glm::vec4(m_pos.x, m_pos.y - m_size.y, m_pos.x + m_size.x, m_pos.y);
 }
 
-void Sprite::set_background_img_selected(std::string img)
+void Sprite::set_size(glm::vec2 size)
 {
-    if (m_img[1].id != -1)
-        glDeleteTextures(1, &m_img[1].id);
-    m_img[1] = createTexture(img, TEXTURE_TYPE::DIFFUSE, true);
+    m_size = size;
+    m_quad = glm::vec4(m_pos.x, m_pos.y - m_size.y, m_pos.x + m_size.x, m_pos.y);
 }
 
-void Sprite::draw(glm::vec2 translate)
+void Sprite::draw(SpriteBatch& batch, glm::vec2 translate)
 {
-    glBindVertexArray(m_vao);
-    m_shader.use();
-    m_shader.setMatrix("proj", m_projection);
-    if (m_img_index != -1)
-        m_shader.setBool("use_bkg_img", true);
-    else
-        m_shader.setBool("use_bkg_img", false);
-    glActiveTexture(GL_TEXTURE0);
+    AtlasRegion img;
     if (m_img_index > -1)
-        glBindTexture(GL_TEXTURE_2D, m_img[m_img_index].id);
+        img = m_img[m_img_index];
     else if (m_img_index == -2)
-        glBindTexture(GL_TEXTURE_2D, m_img_gl);
-    m_shader.setInt("image", 0);
-    m_shader.setVec4f("bkg_color", m_color);
-    m_shader.setFloat("bloom_strength", m_bloom_strength);
-    m_shader.setVec2f("translate", translate);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glBindVertexArray(0);
+        img = m_img_gl;
+    glm::vec4 color{ (m_img_index == -1) ? m_color : glm::vec4(1.0f) };
+    color.a *= m_opacity;
+    batch.add_quad(m_quad + glm::vec4(translate, translate), img.tex_rect, img.texture, color, m_bloom_strength);
 }
 
 // top left corner of mouse pointer
@@ -316,8 +536,3 @@ bool Sprite::mouse_hover(int mouseX, int mouseY)
 {
     return (mouseX >= m_pos.x && mouseX <= (m_pos.x + m_size.x)) && (mouseY <= m_pos.y && mouseY >= (m_pos.y - m_size.y));
 }
-
-void Sprite::resize_screen(int width, int height)
-{
-    m_projection = glm::ortho(0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height));
-}
\ No newline at end of file
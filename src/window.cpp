@@ -3,6 +3,7 @@
 WindowManager::WindowManager(const std::string& title)
 {
 	alive = true;
+	m_stats_overlay = false;
 
 	if(SDL_Init(SDL_INIT_VIDEO) < 0)
 	{
@@ -129,7 +130,7 @@ char* WindowManager::get_text_input()
 	return m_textInput;
 }
 
-bool& WindowManager::isAlive()
+std::atomic<bool>& WindowManager::isAlive()
 {
 	return alive;
 }
@@ -160,6 +161,11 @@ void WindowManager::checkEvents(bool writing)
 			}
 		}
 
+		if (event.e.type == SDL_KEYDOWN && event.e.key.keysym.sym == SDLK_F3 && !event.e.key.repeat)
+		{
+			m_stats_overlay = !m_stats_overlay;
+		}
+
 		if (event.e.type == SDL_MOUSEBUTTONUP)
 		{
 			userInputs.set(9);